@@ -0,0 +1,96 @@
+#include "ClientHandler.h"
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QIODevice>
+#include <QList>
+#include <QString>
+#include <cstdio>
+
+/**
+ * @brief 广播编码开销基准测试
+ *
+ * 对比两种广播路径随客户端数量增长的开销：
+ * - 逐客户端编码：每个客户端都执行一次 packMessage（旧路径）
+ * - 只编码一次：调用线程打包一次，所有客户端共享同一个 QByteArray（新路径）
+ *
+ * 为了只测量编码和分配成本，socket 写入用一个丢弃数据的 QIODevice 代替。
+ */
+
+namespace {
+
+// 丢弃所有写入数据的设备，模拟 socket 写入调用
+class DiscardDevice : public QIODevice {
+public:
+  DiscardDevice() { open(QIODevice::WriteOnly); }
+
+protected:
+  qint64 readData(char *data, qint64 maxSize) override {
+    Q_UNUSED(data)
+    Q_UNUSED(maxSize)
+    return -1;
+  }
+
+  qint64 writeData(const char *data, qint64 maxSize) override {
+    Q_UNUSED(data)
+    return maxSize;
+  }
+};
+
+// 旧路径：每个客户端都重新编码
+qint64 broadcastPerClient(const QString &message, int clientCount,
+                          DiscardDevice &sink) {
+  QElapsedTimer timer;
+  timer.start();
+  for (int i = 0; i < clientCount; ++i) {
+    const QByteArray packet = ClientHandler::packMessage(message);
+    sink.write(packet);
+  }
+  return timer.nsecsElapsed();
+}
+
+// 新路径：只编码一次，所有客户端共享同一个缓冲区
+qint64 broadcastEncodeOnce(const QString &message, int clientCount,
+                           DiscardDevice &sink) {
+  QElapsedTimer timer;
+  timer.start();
+  const QByteArray packet = ClientHandler::packMessage(message);
+  for (int i = 0; i < clientCount; ++i) {
+    const QByteArray shared = packet; // 模拟跨线程传递的隐式共享拷贝
+    sink.write(shared);
+  }
+  return timer.nsecsElapsed();
+}
+
+} // namespace
+
+int main() {
+  const QList<int> clientCounts = {100, 1000, 5000, 20000};
+  const QList<int> payloadSizes = {64, 1024, 16 * 1024};
+  constexpr int ROUNDS = 20;
+
+  DiscardDevice sink;
+
+  std::printf("%-10s %-10s %-18s %-18s %-8s\n", "payload", "clients",
+              "per-client(us)", "encode-once(us)", "speedup");
+
+  for (int payloadSize : payloadSizes) {
+    const QString message(payloadSize, QLatin1Char('x'));
+
+    for (int clientCount : clientCounts) {
+      qint64 perClientNs = 0;
+      qint64 encodeOnceNs = 0;
+      for (int round = 0; round < ROUNDS; ++round) {
+        perClientNs += broadcastPerClient(message, clientCount, sink);
+        encodeOnceNs += broadcastEncodeOnce(message, clientCount, sink);
+      }
+
+      const double perClientUs = perClientNs / 1000.0 / ROUNDS;
+      const double encodeOnceUs = encodeOnceNs / 1000.0 / ROUNDS;
+      std::printf("%-10d %-10d %-18.1f %-18.1f %-8.1f\n", payloadSize,
+                  clientCount, perClientUs, encodeOnceUs,
+                  encodeOnceUs > 0 ? perClientUs / encodeOnceUs : 0.0);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include "ReceiveBuffer.h"
+#include <QByteArray>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QList>
+#include <QtEndian>
+#include <cstdio>
+
+/**
+ * @brief 接收缓冲区解析开销基准测试
+ *
+ * 模拟一次 readyRead 交付大量黏包小消息的场景：把 N 个帧拼接成一个数据块，
+ * 一次性送入缓冲区并解析全部帧。
+ * - 旧实现：每帧构造 QDataStream 读长度，并对缓冲区执行 remove(0, n)
+ * - 新实现：ReceiveBuffer 直接从内存读长度，只移动读游标，最后压缩一次
+ */
+
+namespace {
+
+constexpr qsizetype HEADER_SIZE = sizeof(quint32);
+
+// 生成 frameCount 个拼接在一起的帧
+QByteArray buildCoalescedFrames(int frameCount, int payloadSize) {
+  const QByteArray payload(payloadSize, 'x');
+  QByteArray data;
+  data.reserve(frameCount * (HEADER_SIZE + payloadSize));
+  for (int i = 0; i < frameCount; ++i) {
+    char header[HEADER_SIZE];
+    qToBigEndian(static_cast<quint32>(payloadSize), header);
+    data.append(header, HEADER_SIZE);
+    data.append(payload);
+  }
+  return data;
+}
+
+// 旧实现：QDataStream 读长度 + remove(0, n)
+qsizetype parseWithRemove(const QByteArray &input) {
+  QByteArray buffer;
+  buffer.reserve(4096);
+  buffer.append(input);
+
+  qsizetype payloadBytes = 0;
+  while (buffer.size() >= HEADER_SIZE) {
+    QDataStream stream(buffer);
+    stream.setByteOrder(QDataStream::BigEndian);
+    quint32 messageLength;
+    stream >> messageLength;
+
+    const qsizetype totalSize = HEADER_SIZE + messageLength;
+    if (buffer.size() < totalSize) {
+      break;
+    }
+
+    const QByteArray payload(buffer.constData() + HEADER_SIZE, messageLength);
+    payloadBytes += payload.size();
+    buffer.remove(0, totalSize);
+  }
+  return payloadBytes;
+}
+
+// 新实现：读游标 + 每次读取压缩一次
+qsizetype parseWithCursor(const QByteArray &input) {
+  ReceiveBuffer buffer;
+  buffer.append(input.constData(), input.size());
+
+  qsizetype payloadBytes = 0;
+  while (buffer.size() >= HEADER_SIZE) {
+    const char *frame = buffer.data();
+    const quint32 messageLength = qFromBigEndian<quint32>(frame);
+
+    const qsizetype totalSize = HEADER_SIZE + messageLength;
+    if (buffer.size() < totalSize) {
+      break;
+    }
+
+    const QByteArray payload(frame + HEADER_SIZE, messageLength);
+    payloadBytes += payload.size();
+    buffer.consume(totalSize);
+  }
+  buffer.compact();
+  return payloadBytes;
+}
+
+} // namespace
+
+int main() {
+  constexpr int FRAME_COUNT = 10000;
+  constexpr int ROUNDS = 10;
+  const QList<int> payloadSizes = {16, 64, 256};
+
+  std::printf("%-10s %-10s %-16s %-16s %-8s\n", "payload", "frames",
+              "remove(us)", "cursor(us)", "speedup");
+
+  for (int payloadSize : payloadSizes) {
+    const QByteArray input = buildCoalescedFrames(FRAME_COUNT, payloadSize);
+    const qsizetype expected = static_cast<qsizetype>(FRAME_COUNT) * payloadSize;
+
+    qint64 removeNs = 0;
+    qint64 cursorNs = 0;
+    QElapsedTimer timer;
+    for (int round = 0; round < ROUNDS; ++round) {
+      timer.start();
+      const qsizetype removeBytes = parseWithRemove(input);
+      removeNs += timer.nsecsElapsed();
+
+      timer.start();
+      const qsizetype cursorBytes = parseWithCursor(input);
+      cursorNs += timer.nsecsElapsed();
+
+      if (removeBytes != expected || cursorBytes != expected) {
+        std::fprintf(stderr, "解析结果不一致\n");
+        return 1;
+      }
+    }
+
+    const double removeUs = removeNs / 1000.0 / ROUNDS;
+    const double cursorUs = cursorNs / 1000.0 / ROUNDS;
+    std::printf("%-10d %-10d %-16.1f %-16.1f %-8.1f\n", payloadSize,
+                FRAME_COUNT, removeUs, cursorUs,
+                cursorUs > 0 ? removeUs / cursorUs : 0.0);
+  }
+
+  return 0;
+}
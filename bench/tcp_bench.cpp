@@ -0,0 +1,383 @@
+#include "MessageHandler.h"
+#include "ReceiveBuffer.h"
+#include "ServerStats.h"
+#include "TCPServer.h"
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QtEndian>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+/**
+ * @brief TCP Reactor 回环吞吐量/延迟基准测试
+ *
+ * 在进程内启动 TCPServer（N 个 I/O 线程），服务器把收到的每条消息原样回显
+ * （默认经主线程回显，--in-thread 时由 MessageHandler 在 I/O 线程中就地回显）；
+ * 负载生成器运行在独立线程中，用 M 个回环连接按现有帧格式
+ * [4字节长度(大端)][负载] 闭环收发，每个连接同时保持 depth 条在途消息。
+ *
+ * 负载前 8 字节写入发送时间，收到回显后计算往返延迟。
+ * 对每个（线程数，消息大小）组合输出一行 JSON，便于脚本对比基线：
+ * {"threads":4,"clients":64,"size":1024,"msgs_per_sec":...,"mb_per_sec":...,
+ *  "rtt_p50_us":...,"rtt_p99_us":...,"rtt_p999_us":...,...}
+ */
+
+namespace {
+
+constexpr qsizetype HEADER_SIZE = sizeof(quint32);
+constexpr qsizetype TIMESTAMP_SIZE = sizeof(qint64);
+
+// 一次测量的配置
+struct BenchConfig {
+  int threads = 1;       // 服务器 I/O 线程数
+  int clients = 64;      // 回环连接数
+  int size = 64;         // 负载大小（字节，至少 8）
+  int depth = 1;         // 每个连接的在途消息数
+  int warmupMs = 500;    // 预热时间（不计入结果）
+  int durationMs = 3000; // 测量时间
+  bool inThread = false; // 是否在 I/O 线程中回显
+};
+
+// 一次测量的结果
+struct BenchResult {
+  bool ok = false;            // 是否成功完成
+  QString error;              // 失败原因
+  quint64 messages = 0;       // 测量期间完成的往返次数
+  quint64 payloadBytes = 0;   // 测量期间回显的负载字节数
+  qint64 elapsedNs = 0;       // 实际测量时长
+  LatencyHistogramSnapshot rtt; // 往返延迟分布
+};
+
+// 单个回环连接的状态
+struct ClientState {
+  QTcpSocket *socket = nullptr;
+  ReceiveBuffer buffer;
+};
+
+/**
+ * @brief 负载生成器，运行在独立线程中
+ */
+class LoadGenerator : public QObject {
+  Q_OBJECT
+
+public:
+  LoadGenerator(quint16 port, const BenchConfig &config)
+      : m_config(config), m_port(port) {}
+
+  ~LoadGenerator() override { qDeleteAll(m_clients); }
+
+  BenchResult result() const { return m_result; }
+
+public slots:
+  void start() {
+    // 负载模板：前 8 字节每次发送时写入时间戳
+    m_payloadTemplate = QByteArray(m_config.size, 'x');
+
+    m_timeoutTimer = new QTimer(this);
+    m_timeoutTimer->setSingleShot(true);
+    connect(m_timeoutTimer, &QTimer::timeout, this,
+            [this]() { fail("连接服务器超时"); });
+    m_timeoutTimer->start(10000);
+
+    for (int i = 0; i < m_config.clients; ++i) {
+      auto *state = new ClientState;
+      state->socket = new QTcpSocket(this);
+      state->socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+      connect(state->socket, &QTcpSocket::connected, this,
+              &LoadGenerator::onConnected);
+      connect(state->socket, &QTcpSocket::readyRead, this,
+              [this, state]() { onReadyRead(state); });
+      connect(state->socket, &QTcpSocket::errorOccurred, this,
+              [this, state]() { fail(state->socket->errorString()); });
+      m_clients.append(state);
+      state->socket->connectToHost(QHostAddress::LocalHost, m_port);
+    }
+  }
+
+signals:
+  void finished();
+
+private slots:
+  void onConnected() {
+    if (++m_connected < m_config.clients) {
+      return;
+    }
+    m_timeoutTimer->stop();
+
+    // 全部连接就绪后开始收发，预热结束后才开始统计
+    m_running = true;
+    for (ClientState *state : std::as_const(m_clients)) {
+      for (int i = 0; i < m_config.depth; ++i) {
+        sendFrame(state);
+      }
+    }
+    QTimer::singleShot(m_config.warmupMs, this, &LoadGenerator::beginMeasure);
+  }
+
+  void beginMeasure() {
+    if (!m_running) {
+      return;
+    }
+    m_histogram = std::make_unique<LatencyHistogram>();
+    m_messages = 0;
+    m_payloadBytes = 0;
+    m_measureStartNs = LatencyHistogram::nowNs();
+    m_measuring = true;
+    QTimer::singleShot(m_config.durationMs, this, &LoadGenerator::finish);
+  }
+
+  void finish() {
+    if (!m_running) {
+      return;
+    }
+    m_running = false;
+    m_measuring = false;
+
+    m_result.ok = true;
+    m_result.messages = m_messages;
+    m_result.payloadBytes = m_payloadBytes;
+    m_result.elapsedNs = LatencyHistogram::nowNs() - m_measureStartNs;
+    m_result.rtt = m_histogram->snapshot();
+    closeAll();
+  }
+
+private:
+  void onReadyRead(ClientState *state) {
+    state->buffer.readFrom(state->socket);
+
+    while (state->buffer.size() >= HEADER_SIZE) {
+      const char *frame = state->buffer.data();
+      const quint32 length = qFromBigEndian<quint32>(frame);
+      const qsizetype totalSize = HEADER_SIZE + length;
+      if (state->buffer.size() < totalSize) {
+        state->buffer.reserveFrame(totalSize);
+        break;
+      }
+
+      qint64 sentNs = 0;
+      if (length >= TIMESTAMP_SIZE) {
+        std::memcpy(&sentNs, frame + HEADER_SIZE, TIMESTAMP_SIZE);
+      }
+      state->buffer.consume(totalSize);
+
+      if (m_measuring) {
+        m_histogram->record(LatencyHistogram::nowNs() - sentNs);
+        ++m_messages;
+        m_payloadBytes += length;
+      }
+      if (m_running) {
+        sendFrame(state);
+      }
+    }
+    state->buffer.compact();
+  }
+
+  void sendFrame(ClientState *state) {
+    // 一次分配完整帧：长度头 + 时间戳 + 模板负载
+    const qint64 nowNs = LatencyHistogram::nowNs();
+    QByteArray frame(HEADER_SIZE + m_payloadTemplate.size(), Qt::Uninitialized);
+    qToBigEndian(static_cast<quint32>(m_payloadTemplate.size()), frame.data());
+    std::memcpy(frame.data() + HEADER_SIZE, m_payloadTemplate.constData(),
+                m_payloadTemplate.size());
+    std::memcpy(frame.data() + HEADER_SIZE, &nowNs, TIMESTAMP_SIZE);
+    state->socket->write(frame);
+  }
+
+  void fail(const QString &error) {
+    if (m_result.ok || !m_result.error.isEmpty()) {
+      return;
+    }
+    m_running = false;
+    m_measuring = false;
+    m_result.error = error;
+    closeAll();
+  }
+
+  void closeAll() {
+    for (ClientState *state : std::as_const(m_clients)) {
+      state->socket->disconnect(this);
+      state->socket->abort();
+    }
+    emit finished();
+  }
+
+  BenchConfig m_config;
+  BenchResult m_result;
+  QList<ClientState *> m_clients;
+  QByteArray m_payloadTemplate;
+  std::unique_ptr<LatencyHistogram> m_histogram =
+      std::make_unique<LatencyHistogram>();
+  QTimer *m_timeoutTimer = nullptr;
+  qint64 m_measureStartNs = 0;
+  quint64 m_messages = 0;
+  quint64 m_payloadBytes = 0;
+  int m_connected = 0;
+  quint16 m_port;
+  bool m_running = false;
+  bool m_measuring = false;
+};
+
+// 在 I/O 线程中原样回显（无状态，天然线程安全）
+class EchoHandler : public MessageHandler {
+public:
+  bool handleMessage(const MessageContext &context,
+                     const QByteArray &data) override {
+    context.reply(data);
+    return true;
+  }
+};
+
+// 解析逗号分隔的整数列表
+QList<int> parseIntList(const QString &text) {
+  QList<int> values;
+  for (const QString &item : text.split(',', Qt::SkipEmptyParts)) {
+    bool ok = false;
+    const int value = item.trimmed().toInt(&ok);
+    if (ok && value > 0) {
+      values.append(value);
+    }
+  }
+  return values;
+}
+
+// 执行一次测量
+BenchResult runOnce(const BenchConfig &config, WorkerStats *serverTotal) {
+  TCPServer server(config.threads);
+
+  // 回显：原样发回负载。经主线程时每条消息两次跨线程（sendData 在调用线程
+  // 打包，由客户端所在的 I/O 线程写出）；in-thread 时在解码的 I/O 线程中直接写出
+  if (config.inThread) {
+    server.setMessageHandler(MessageHandlerPtr(new EchoHandler));
+  } else {
+    QObject::connect(&server, &TCPServer::dataReceived, &server,
+                     [&server](ClientId clientId, const QByteArray &data) {
+                       server.sendData(clientId, data);
+                     });
+  }
+
+  if (!server.startServer(0)) {
+    BenchResult result;
+    result.error = "启动服务器失败";
+    return result;
+  }
+
+  QThread clientThread;
+  auto *generator = new LoadGenerator(server.listeningPort(), config);
+  generator->moveToThread(&clientThread);
+  QObject::connect(&clientThread, &QThread::started, generator,
+                   &LoadGenerator::start);
+  QObject::connect(&clientThread, &QThread::finished, generator,
+                   &QObject::deleteLater);
+
+  QEventLoop loop;
+  QObject::connect(generator, &LoadGenerator::finished, &loop,
+                   &QEventLoop::quit, Qt::QueuedConnection);
+  clientThread.start();
+  loop.exec();
+
+  // 生成器已停止收发，结果在线程结束前读取
+  const BenchResult result = generator->result();
+  clientThread.quit();
+  clientThread.wait();
+
+  *serverTotal = server.stats().total();
+  server.stopServer();
+  return result;
+}
+
+// 输出一行 JSON
+void printResult(const BenchConfig &config, const BenchResult &result,
+                 const WorkerStats &serverTotal) {
+  QJsonObject json;
+  json["threads"] = config.threads;
+  json["clients"] = config.clients;
+  json["size"] = config.size;
+  json["depth"] = config.depth;
+  json["duration_ms"] = config.durationMs;
+  json["in_thread"] = config.inThread;
+
+  if (!result.ok) {
+    json["error"] = result.error;
+  } else {
+    const double seconds = result.elapsedNs / 1e9;
+    const auto us = [&result](double quantile) {
+      return result.rtt.percentileNs(quantile) / 1000.0;
+    };
+    json["messages"] = static_cast<qint64>(result.messages);
+    json["msgs_per_sec"] = seconds > 0 ? result.messages / seconds : 0.0;
+    json["mb_per_sec"] =
+        seconds > 0 ? result.payloadBytes / seconds / (1024.0 * 1024.0) : 0.0;
+    json["rtt_p50_us"] = us(0.50);
+    json["rtt_p99_us"] = us(0.99);
+    json["rtt_p999_us"] = us(0.999);
+    json["server_dispatch_p99_us"] =
+        serverTotal.dispatchLatency.percentileNs(0.99) / 1000.0;
+    json["server_parse_errors"] = static_cast<qint64>(serverTotal.parseErrors);
+  }
+
+  std::printf("%s\n", QJsonDocument(json).toJson(QJsonDocument::Compact)
+                          .constData());
+  std::fflush(stdout);
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("TCP Reactor 回环吞吐量/延迟基准测试");
+  parser.addHelpOption();
+  const QCommandLineOption threadsOption(
+      "threads", "I/O 线程数列表（逗号分隔）", "list", "1,2,4");
+  const QCommandLineOption sizesOption(
+      "sizes", "负载大小列表（字节，逗号分隔）", "list", "64,1024,16384");
+  const QCommandLineOption clientsOption("clients", "回环连接数", "n", "64");
+  const QCommandLineOption depthOption("depth", "每个连接的在途消息数", "n",
+                                       "1");
+  const QCommandLineOption durationOption("duration", "每组测量时间（毫秒）",
+                                          "ms", "3000");
+  const QCommandLineOption inThreadOption(
+      "in-thread", "在 I/O 线程中回显（MessageHandler），不经过主线程");
+  parser.addOptions({threadsOption, sizesOption, clientsOption, depthOption,
+                     durationOption, inThreadOption});
+  parser.process(app);
+
+  const QList<int> threadCounts = parseIntList(parser.value(threadsOption));
+  const QList<int> sizes = parseIntList(parser.value(sizesOption));
+
+  BenchConfig base;
+  base.clients = qMax(1, parser.value(clientsOption).toInt());
+  base.depth = qMax(1, parser.value(depthOption).toInt());
+  base.durationMs = qMax(100, parser.value(durationOption).toInt());
+  base.inThread = parser.isSet(inThreadOption);
+
+  bool allOk = true;
+  for (int threads : threadCounts) {
+    for (int size : sizes) {
+      BenchConfig config = base;
+      config.threads = threads;
+      config.size = qMax<int>(TIMESTAMP_SIZE, size);
+
+      WorkerStats serverTotal;
+      const BenchResult result = runOnce(config, &serverTotal);
+      printResult(config, result, serverTotal);
+      allOk = allOk && result.ok;
+    }
+  }
+
+  return allOk ? 0 : 1;
+}
+
+#include "tcp_bench.moc"
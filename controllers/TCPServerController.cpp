@@ -22,7 +22,7 @@ TCPServerController::TCPServerController(QObject *parent)
 TCPServerController::~TCPServerController() = default;
 
 bool TCPServerController::isListening() const {
-  return m_server->isListening();
+  return m_server->isRunning();
 }
 
 int TCPServerController::clientCount() const { return m_server->clientCount(); }
@@ -35,7 +35,7 @@ void TCPServerController::startServer(int port) {
 
 void TCPServerController::stopServer() { m_server->stopServer(); }
 
-void TCPServerController::sendMessage(qintptr clientId,
+void TCPServerController::sendMessage(quint64 clientId,
                                       const QString &message) {
   m_server->sendMessage(clientId, message);
 }
@@ -60,18 +60,18 @@ void TCPServerController::onServerStopped() {
   emit clientCountChanged();
 }
 
-void TCPServerController::onClientConnected(qintptr clientId,
+void TCPServerController::onClientConnected(quint64 clientId,
                                             const QString &address) {
   appendLog(QString("[客户端 %1] 已连接 %2").arg(clientId).arg(address));
   emit clientCountChanged();
 }
 
-void TCPServerController::onClientDisconnected(qintptr clientId) {
+void TCPServerController::onClientDisconnected(quint64 clientId) {
   appendLog(QString("[客户端 %1] 已断开").arg(clientId));
   emit clientCountChanged();
 }
 
-void TCPServerController::onMessageReceived(qintptr clientId,
+void TCPServerController::onMessageReceived(quint64 clientId,
                                             const QString &message) {
   appendLog(QString("[客户端 %1] 收到: %2").arg(clientId).arg(message));
 }
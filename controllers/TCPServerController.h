@@ -30,7 +30,7 @@ public:
 
   Q_INVOKABLE void stopServer();
 
-  Q_INVOKABLE void sendMessage(qintptr clientId, const QString &message);
+  Q_INVOKABLE void sendMessage(quint64 clientId, const QString &message);
 
   Q_INVOKABLE void broadcastMessage(const QString &message);
 
@@ -48,11 +48,11 @@ private slots:
 
   void onServerStopped();
 
-  void onClientConnected(qintptr clientId, const QString &address);
+  void onClientConnected(quint64 clientId, const QString &address);
 
-  void onClientDisconnected(qintptr clientId);
+  void onClientDisconnected(quint64 clientId);
 
-  void onMessageReceived(qintptr clientId, const QString &message);
+  void onMessageReceived(quint64 clientId, const QString &message);
 
   void onErrorOccurred(const QString &error);
 
@@ -0,0 +1,68 @@
+#include "NetLog.h"
+#include <QStringList>
+#include <chrono>
+
+// 调试级别默认关闭，只输出 info 及以上
+Q_LOGGING_CATEGORY(lcNetIo, "net.io", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNetPayload, "net.payload", QtInfoMsg)
+Q_LOGGING_CATEGORY(lcNetUdp, "net.udp", QtInfoMsg)
+
+namespace {
+
+// 单调时钟毫秒数（不受系统时间调整影响）
+qint64 monotonicMs() {
+  using namespace std::chrono;
+  return duration_cast<milliseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+LogRateLimiter::LogRateLimiter(int maxPerSecond)
+    : m_maxPerSecond(maxPerSecond) {}
+
+bool LogRateLimiter::allow() {
+  if (m_maxPerSecond <= 0) {
+    return true;
+  }
+
+  const qint64 now = monotonicMs();
+  if (now - m_windowStartMs >= 1000) {
+    // 进入新窗口，先报告上一个窗口被抑制的条数
+    if (m_suppressed > 0) {
+      qCDebug(lcNetIo) << "[NetLog] 上一秒抑制了" << m_suppressed << "条日志";
+    }
+    m_windowStartMs = now;
+    m_count = 0;
+    m_suppressed = 0;
+  }
+
+  if (m_count < m_maxPerSecond) {
+    ++m_count;
+    return true;
+  }
+  ++m_suppressed;
+  return false;
+}
+
+namespace NetLog {
+
+QByteArray payloadPreview(const QByteArray &data, int maxBytes) {
+  if (data.size() <= maxBytes) {
+    return data.toHex(' ');
+  }
+  return data.first(maxBytes).toHex(' ') + " ... (" +
+         QByteArray::number(data.size()) + " 字节)";
+}
+
+void setHotPathLogging(bool enabled, bool includePayload) {
+  const QString value = enabled ? "true" : "false";
+  QStringList rules;
+  rules << QString("net.io.debug=%1").arg(value)
+        << QString("net.udp.debug=%1").arg(value)
+        << QString("net.payload.debug=%1")
+               .arg(enabled && includePayload ? "true" : "false");
+  QLoggingCategory::setFilterRules(rules.join('\n'));
+}
+
+} // namespace NetLog
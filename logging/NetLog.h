@@ -0,0 +1,101 @@
+#ifndef NETLOG_H
+#define NETLOG_H
+
+#include <QByteArray>
+#include <QLoggingCategory>
+#include <QtGlobal>
+
+/**
+ * @brief 网络热路径日志
+ *
+ * 收发路径每条消息都会打日志，即使输出被过滤，参数格式化本身也有开销。
+ * 这里提供三层控制：
+ * - 编译期：NET_LOG_MIN_LEVEL 以下级别的 NET_* 宏展开为空语句，参数不求值
+ *   （0=debug，1=info，2=warning，由 CMake 缓存变量 NET_LOG_MIN_LEVEL 设置）
+ * - 运行期：按日志分类开关，调试级别默认关闭，关闭时参数同样不求值
+ * - 限流：NET_DEBUG_LIMITED 按连接限制每秒输出条数，超出部分只计数
+ *
+ * 日志分类：
+ * - net.io：TCP 收发、广播等逐消息事件
+ * - net.payload：消息负载内容（十六进制预览），默认关闭
+ * - net.udp：UDP 收发逐数据报事件
+ *
+ * 调试时可通过 QT_LOGGING_RULES="net.io.debug=true" 或
+ * NetLog::setHotPathLogging(true) 在运行期打开。
+ */
+
+#ifndef NET_LOG_MIN_LEVEL
+#define NET_LOG_MIN_LEVEL 0
+#endif
+
+Q_DECLARE_LOGGING_CATEGORY(lcNetIo)
+Q_DECLARE_LOGGING_CATEGORY(lcNetPayload)
+Q_DECLARE_LOGGING_CATEGORY(lcNetUdp)
+
+// 编译期级别裁剪：被裁剪的宏展开为 while (false)，后续 << 参数不会求值
+#if NET_LOG_MIN_LEVEL <= 0
+#define NET_DEBUG(category) qCDebug(category)
+#else
+#define NET_DEBUG(category) QT_NO_QDEBUG_MACRO()
+#endif
+
+#if NET_LOG_MIN_LEVEL <= 1
+#define NET_INFO(category) qCInfo(category)
+#else
+#define NET_INFO(category) QT_NO_QDEBUG_MACRO()
+#endif
+
+#define NET_WARNING(category) qCWarning(category)
+
+// 限流的调试日志：分类已启用且限流器放行时才格式化参数；
+// 与 qCDebug 相同采用单语句 for 形式，避免在无花括号的 if/else 中吞掉 else
+#if NET_LOG_MIN_LEVEL <= 0
+#define NET_DEBUG_LIMITED(category, limiter)                                   \
+  for (bool qt_enabled =                                                       \
+           category().isDebugEnabled() && (limiter).allow();                  \
+       qt_enabled; qt_enabled = false)                                         \
+    QMessageLogger(QT_MESSAGELOG_FILE, QT_MESSAGELOG_LINE,                     \
+                   QT_MESSAGELOG_FUNC, category().categoryName())              \
+        .debug()
+#else
+#define NET_DEBUG_LIMITED(category, limiter) QT_NO_QDEBUG_MACRO()
+#endif
+
+/**
+ * @brief 按连接的日志限流器
+ *
+ * 每个连接持有一个实例，在一秒的窗口内最多放行 maxPerSecond 条日志，
+ * 超出部分只计数，下一个窗口的第一条日志前会补一条被抑制条数的提示。
+ * 只在日志分类已启用时才会被调用，关闭日志时没有任何开销。
+ *
+ * 非线程安全：与所属连接在同一线程中使用。
+ */
+class LogRateLimiter {
+public:
+  explicit LogRateLimiter(int maxPerSecond = 10);
+
+  // 是否放行本条日志
+  bool allow();
+
+  // 设置每秒最多放行的条数（0 表示不限制）
+  void setMaxPerSecond(int maxPerSecond) { m_maxPerSecond = maxPerSecond; }
+
+private:
+  qint64 m_windowStartMs = 0; // 当前窗口起点（毫秒，单调时钟）
+  int m_maxPerSecond;         // 每秒最多放行条数
+  int m_count = 0;            // 当前窗口已放行条数
+  quint64 m_suppressed = 0;   // 当前窗口被抑制的条数
+};
+
+namespace NetLog {
+
+// 负载预览：最多 maxBytes 字节的十六进制表示，超出部分以长度标注
+QByteArray payloadPreview(const QByteArray &data, int maxBytes = 64);
+
+// 运行期开关热路径日志（net.io / net.udp 的调试级别，可选负载预览）
+// 注意：会替换由 QLoggingCategory::setFilterRules 设置的全部规则
+void setHotPathLogging(bool enabled, bool includePayload = false);
+
+} // namespace NetLog
+
+#endif // NETLOG_H
@@ -1,13 +1,16 @@
 #include "TCPClient.h"
 #include <QDebug>
+#include <QHostAddress>
+#include <QMetaMethod>
 
 TCPClient::TCPClient(QObject *parent)
     : QObject(parent), m_socket(new QTcpSocket(this)),
-      m_reconnectTimer(new QTimer(this)),
+      m_reconnectTimer(new QTimer(this)), m_writeFlushTimer(new QTimer(this)),
+      m_heartbeatTimer(new QTimer(this)), m_unansweredPings(0),
+      m_preferredVersion(FrameCodec::VERSION_1),
+      m_protocolVersion(FrameCodec::VERSION_1), m_peerFeatures(0),
       m_reconnectInterval(3000), // 默认3秒重连
       m_port(0), m_autoReconnect(false), m_isManualDisconnect(false) {
-  m_receiveBuffer.reserve(4096);
-
   // 连接信号
   connect(m_socket, &QTcpSocket::connected, this, &TCPClient::onConnected);
   connect(m_socket, &QTcpSocket::disconnected, this,
@@ -19,6 +22,14 @@ TCPClient::TCPClient(QObject *parent)
   m_reconnectTimer->setSingleShot(true);
   connect(m_reconnectTimer, &QTimer::timeout, this,
           &TCPClient::attemptReconnect);
+
+  // 配置写合并定时器
+  m_writeFlushTimer->setSingleShot(true);
+  connect(m_writeFlushTimer, &QTimer::timeout, this,
+          &TCPClient::flushPendingWrites);
+
+  // 配置心跳定时器（连接成功后启动）
+  connect(m_heartbeatTimer, &QTimer::timeout, this, &TCPClient::sendHeartbeat);
 }
 
 TCPClient::~TCPClient() { disconnectFromServer(); }
@@ -34,6 +45,7 @@ void TCPClient::connectToServer(const QString &host, quint16 port) {
   m_port = port;
   m_isManualDisconnect = false;
   m_receiveBuffer.clear(); // 清空接收缓冲区
+  m_chunks.clear();
 
   qDebug() << "正在连接到服务器:" << host << ":" << port;
   m_socket->connectToHost(host, port);
@@ -43,6 +55,9 @@ void TCPClient::disconnectFromServer() {
   m_isManualDisconnect = true;
   m_reconnectTimer->stop();
 
+  // 先写出写合并缓存，避免丢失已排队的数据
+  flushPendingWrites();
+
   if (m_socket->state() != QAbstractSocket::UnconnectedState) {
     m_socket->disconnectFromHost();
     qDebug() << "手动断开连接";
@@ -51,23 +66,89 @@ void TCPClient::disconnectFromServer() {
   m_receiveBuffer.clear(); // 清空接收缓冲区
 }
 
-void TCPClient::sendMessage(const QString &message) {
+void TCPClient::sendData(const QByteArray &data) {
   if (m_socket->state() != QAbstractSocket::ConnectedState) {
     emit errorOccurred("未连接到服务器");
     return;
   }
 
-  QByteArray packet = packMessage(message);
+  writePacket(packMessage(data));
+}
+
+void TCPClient::sendChunk(quint32 streamId, const QByteArray &data,
+                          bool last) {
+  if (m_socket->state() != QAbstractSocket::ConnectedState) {
+    emit errorOccurred("未连接到服务器");
+    return;
+  }
+  if (m_protocolVersion < FrameCodec::VERSION_2 ||
+      (m_peerFeatures & FrameCodec::FEATURE_CHUNKS) == 0) {
+    emit errorOccurred("服务器不支持分块消息");
+    return;
+  }
+
+  // 超过单块上限时拆分，只有最后一块带结束标志
+  qsizetype offset = 0;
+  do {
+    const qsizetype size =
+        qMin<qsizetype>(data.size() - offset, FrameCodec::MAX_CHUNK_SIZE);
+    const bool isLast = last && offset + size == data.size();
+    writePacket(FrameCodec::packChunk(streamId, data.constData() + offset,
+                                      size, isLast));
+    offset += size;
+  } while (offset < data.size());
+}
+
+void TCPClient::writePacket(const QByteArray &packet) {
+  // 写合并模式：先缓存，本次事件循环迭代结束（或达到字节阈值）时统一写出
+  if (m_writeCoalescer.isEnabled()) {
+    if (m_writeCoalescer.enqueue(packet)) {
+      flushPendingWrites();
+    } else if (!m_writeFlushTimer->isActive()) {
+      m_writeFlushTimer->start(m_writeCoalescer.options().flushDelayMs);
+    }
+    return;
+  }
+
   qint64 written = m_socket->write(packet);
   m_socket->flush();
 
   if (written != packet.size()) {
     emit errorOccurred("发送消息不完整");
   } else {
-    qDebug() << "发送消息:" << message << "(字节数:" << packet.size() << ")";
+    NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+        << "发送消息 (字节数:" << packet.size() << ")";
+  }
+}
+
+void TCPClient::flushPendingWrites() {
+  m_writeFlushTimer->stop();
+  if (m_writeCoalescer.isEmpty()) {
+    return;
+  }
+
+  if (m_socket->state() != QAbstractSocket::ConnectedState) {
+    m_writeCoalescer.clear();
+    return;
+  }
+
+  // 所有缓存帧合并为一个缓冲区，一次写入
+  const QByteArray data = m_writeCoalescer.takeAll();
+  qint64 written = m_socket->write(data);
+  m_socket->flush();
+
+  if (written != data.size()) {
+    emit errorOccurred("发送消息不完整");
+  } else {
+    NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+        << "合并写出 (字节数:" << data.size() << ")";
   }
 }
 
+void TCPClient::sendMessage(const QString &message) {
+  sendData(message.toUtf8());
+}
+
 bool TCPClient::isConnected() const {
   return m_socket->state() == QAbstractSocket::ConnectedState;
 }
@@ -81,81 +162,169 @@ void TCPClient::setAutoReconnect(bool enable) {
 
 void TCPClient::setReconnectInterval(int msec) { m_reconnectInterval = msec; }
 
-QByteArray TCPClient::packMessage(const QString &message) {
-  // 消息格式：[4字节长度(网络字节序/大端)][消息内容UTF-8]
-  QByteArray utf8Data = message.toUtf8();
-  quint32 messageLength = static_cast<quint32>(utf8Data.size());
+void TCPClient::setWriteCoalescing(const WriteCoalescingOptions &options) {
+  if (!options.enabled) {
+    flushPendingWrites();
+  }
+  WriteCoalescingOptions normalized = options;
+  normalized.flushDelayMs = qMax(0, normalized.flushDelayMs);
+  m_writeCoalescer.setOptions(normalized);
+}
+
+void TCPClient::setHeartbeat(const HeartbeatOptions &options) {
+  m_heartbeat = options;
+  m_heartbeat.intervalMs = qMax(0, m_heartbeat.intervalMs);
+  m_heartbeat.maxMissed = qMax(1, m_heartbeat.maxMissed);
 
-  // 预分配内存：4字节长度 + 消息内容
-  QByteArray packet;
-  packet.reserve(sizeof(quint32) + messageLength);
+  m_heartbeatTimer->stop();
+  m_unansweredPings = 0;
+  if (m_heartbeat.intervalMs > 0 && isConnected()) {
+    m_heartbeatTimer->start(m_heartbeat.intervalMs);
+  }
+}
 
-  QDataStream stream(&packet, QIODevice::WriteOnly);
-  stream.setByteOrder(QDataStream::BigEndian); // 设置为网络字节序（大端）
+void TCPClient::setProtocolVersion(int version) {
+  m_preferredVersion =
+      qBound(FrameCodec::VERSION_1, version, FrameCodec::LATEST_VERSION);
+}
 
-  stream << messageLength; // 写入4字节长度
-  packet.append(utf8Data); // 追加消息内容
+void TCPClient::setCompression(const CompressionOptions &options) {
+  m_compression = options;
+}
 
-  return packet;
+QByteArray TCPClient::packMessage(const QByteArray &data) const {
+  // 只有协商出 v2 且服务器能解码压缩帧时才压缩
+  if (m_protocolVersion >= FrameCodec::VERSION_2 &&
+      (m_peerFeatures & FrameCodec::FEATURE_COMPRESSION) != 0) {
+    const QByteArray compressed =
+        FrameCompression::compress(data, m_compression);
+    if (!compressed.isEmpty()) {
+      return FrameCodec::packFrame(
+          m_protocolVersion, FrameCodec::MessageType::Data,
+          FrameCodec::FLAG_COMPRESSED, compressed.constData(),
+          compressed.size());
+    }
+  }
+  return FrameCodec::packData(data, m_protocolVersion);
 }
 
 void TCPClient::parseReceivedData() {
-  // 读取所有可用数据到缓冲区
-  m_receiveBuffer.append(m_socket->readAll());
-
-  // 循环解析完整的消息
-  while (m_receiveBuffer.size() >= static_cast<qsizetype>(sizeof(quint32))) {
-    // 读取消息长度（前4字节，大端）
-    QDataStream stream(m_receiveBuffer);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    quint32 messageLength;
-    stream >> messageLength;
-
-    // 检查消息长度合法性
-    constexpr quint32 MAX_MESSAGE_SIZE = 10 * 1024 * 1024; // 10MB上限
-    if (messageLength > MAX_MESSAGE_SIZE) {
-      qWarning() << "收到的消息过大:" << messageLength;
+  // 直接读入接收缓冲区尾部；服务器有任何数据到达都说明仍然存活
+  if (m_receiveBuffer.readFrom(m_socket) > 0) {
+    m_unansweredPings = 0;
+  }
+
+  // 循环解析完整的消息，只移动读游标
+  while (!m_receiveBuffer.isEmpty()) {
+    // 直接在缓冲区上解码帧头，第一个字节区分 v1 和 v2
+    const char *frame = m_receiveBuffer.data();
+    FrameCodec::FrameHeader header;
+    const FrameCodec::DecodeStatus status =
+        FrameCodec::decodeHeader(frame, m_receiveBuffer.size(), &header);
+    if (status == FrameCodec::DecodeStatus::NeedMore) {
+      break;
+    }
+
+    // 帧头非法或消息过大（控制帧只允许很短的内容）
+    if (status == FrameCodec::DecodeStatus::Invalid) {
+      qWarning() << "收到非法帧头或过大的消息";
       emit errorOccurred(QString("消息过大，断开连接"));
       m_socket->disconnectFromHost();
       return;
     }
 
     // 检查是否接收到完整消息（处理半包）
-    int totalSize = static_cast<int>(sizeof(quint32) + messageLength);
+    const qsizetype totalSize = header.frameSize();
     if (m_receiveBuffer.size() < totalSize) {
       // 数据不完整，等待更多数据（半包）
-      qDebug() << "数据不完整，等待..."
-               << "已接收:" << m_receiveBuffer.size() << "需要:" << totalSize;
+      NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+          << "数据不完整，等待..."
+          << "已接收:" << m_receiveBuffer.size() << "需要:" << totalSize;
 
       // 预留足够空间，避免后续频繁分配
-      if (m_receiveBuffer.capacity() < totalSize) {
-        m_receiveBuffer.reserve(totalSize + 1024);
-      }
+      m_receiveBuffer.reserveFrame(totalSize);
       break;
     }
 
-    // 提取消息内容（跳过前4字节的长度字段）
-    QString message = QString::fromUtf8(
-        m_receiveBuffer.constData() + sizeof(quint32), messageLength);
+    // 分块帧：先复制本块再移动读游标，交付时接收缓冲区可能被重新分配
+    const char *payload = frame + header.headerSize;
+    if (header.type == FrameCodec::MessageType::Chunk) {
+      const QByteArray chunk(payload, header.payloadSize);
+      m_receiveBuffer.consume(totalSize);
+      if (!handleChunkFrame(header, chunk.constData())) {
+        return;
+      }
+      continue;
+    }
 
-    // 从缓冲区移除已处理的消息（处理黏包）
-    m_receiveBuffer.remove(0, totalSize);
+    // 控制帧在本线程内处理，不向上投递
+    if (header.type != FrameCodec::MessageType::Data) {
+      handleControlFrame(header.type, payload, header.payloadSize);
+      m_receiveBuffer.consume(totalSize);
+      continue;
+    }
 
-    // 发出消息信号
-    if (!message.isEmpty()) {
-      qDebug() << "收到完整消息:" << message;
-      emit messageReceived(message);
+    // 提取消息内容（跳过帧头），保持原始字节；压缩帧先解压
+    QByteArray data;
+    if ((header.flags & FrameCodec::FLAG_COMPRESSED) != 0) {
+      if (!FrameCompression::decompress(payload, header.payloadSize, &data)) {
+        qWarning() << "压缩帧解压失败";
+        emit errorOccurred(QString("压缩帧解压失败，断开连接"));
+        m_socket->disconnectFromHost();
+        return;
+      }
+    } else {
+      data = QByteArray(payload, header.payloadSize);
+    }
+
+    // 移动读游标（处理黏包），不移动剩余数据
+    m_receiveBuffer.consume(totalSize);
+
+    // 发出数据信号
+    if (!data.isEmpty()) {
+      NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+          << "收到完整消息 (字节数:" << data.size() << ")";
+      NET_DEBUG(lcNetPayload) << "负载:" << NetLog::payloadPreview(data);
+      dispatchData(data);
     }
   }
 
-  // 缓冲区缩容策略：如果缓冲区空闲空间过大（>8KB）且已用空间较小，则缩容
-  constexpr int SHRINK_THRESHOLD = 8192;
-  if (m_receiveBuffer.capacity() > SHRINK_THRESHOLD &&
-      m_receiveBuffer.size() < 1024) {
-    QByteArray temp(m_receiveBuffer);
-    m_receiveBuffer = std::move(temp);
-    m_receiveBuffer.reserve(4096); // 恢复初始容量
+  // 每次读取最多压缩一次（含缩容策略）
+  m_receiveBuffer.compact();
+}
+
+bool TCPClient::handleChunkFrame(const FrameCodec::FrameHeader &header,
+                                 const char *payload) {
+  quint32 streamId = 0;
+  if (!FrameCodec::readChunkStreamId(payload, header.payloadSize, &streamId)) {
+    qWarning() << "分块帧格式错误";
+    emit errorOccurred(QString("分块帧格式错误，断开连接"));
+    m_socket->disconnectFromHost();
+    return false;
+  }
+
+  const bool last = (header.flags & FrameCodec::FLAG_FINAL) != 0;
+  qint64 offset = 0;
+  QByteArray data;
+  switch (m_chunks.feed(streamId, payload + FrameCodec::CHUNK_ID_SIZE,
+                        header.payloadSize - FrameCodec::CHUNK_ID_SIZE, last,
+                        &offset, &data)) {
+  case ChunkAssembler::Result::Chunk:
+    emit messageChunk(streamId, offset, data, last);
+    return true;
+  case ChunkAssembler::Result::Message:
+    if (!data.isEmpty()) {
+      dispatchData(data);
+    }
+    return true;
+  case ChunkAssembler::Result::Pending:
+    return true;
+  case ChunkAssembler::Result::Error:
+  default:
+    qWarning() << "分块消息过多或过大";
+    emit errorOccurred(QString("分块消息过多或过大，断开连接"));
+    m_socket->disconnectFromHost();
+    return false;
   }
 }
 
@@ -182,12 +351,31 @@ void TCPClient::onConnected() {
 
   qDebug() << "已连接到服务器:" << serverAddressStr << ":"
            << m_socket->peerPort();
+
+  // 新连接重新测量 RTT
+  m_rtt.reset();
+  m_unansweredPings = 0;
+
+  // 新连接从 v1 开始，服务器回复 Hello 后再切换
+  m_protocolVersion = FrameCodec::VERSION_1;
+  m_peerFeatures = 0;
+  if (m_preferredVersion > FrameCodec::VERSION_1) {
+    writeControlFrame(FrameCodec::packHello(m_preferredVersion,
+                                            FrameCodec::SUPPORTED_FEATURES));
+  }
+  if (m_heartbeat.intervalMs > 0) {
+    m_heartbeatTimer->start(m_heartbeat.intervalMs);
+  }
   emit connected();
 }
 
 void TCPClient::onDisconnected() {
   qDebug() << "与服务器断开连接";
   m_receiveBuffer.clear(); // 清空接收缓冲区
+  m_chunks.clear();         // 丢弃未完成的分块消息
+  m_writeCoalescer.clear(); // 丢弃未写出的数据
+  m_writeFlushTimer->stop();
+  m_heartbeatTimer->stop();
   emit disconnected();
 
   // 自动重连逻辑
@@ -223,3 +411,87 @@ void TCPClient::attemptReconnect() {
     m_socket->connectToHost(m_host, m_port);
   }
 }
+
+void TCPClient::sendHeartbeat() {
+  if (m_socket->state() != QAbstractSocket::ConnectedState) {
+    return;
+  }
+
+  if (m_unansweredPings >= m_heartbeat.maxMissed) {
+    qWarning() << "连续" << m_unansweredPings << "次心跳未应答，判定服务器失联";
+    m_heartbeatTimer->stop();
+    emit errorOccurred("心跳超时，连接已失联");
+
+    // 中止连接：发出 disconnected，启用自动重连时随后重连
+    m_socket->abort();
+    return;
+  }
+
+  ++m_unansweredPings;
+  writeControlFrame(
+      FrameCodec::packPing(RttEstimator::nowNs(), m_protocolVersion));
+}
+
+void TCPClient::handleControlFrame(FrameCodec::MessageType type,
+                                   const char *payload, qsizetype size) {
+  qint64 timestampNs = 0;
+  int version = 0;
+  quint8 features = 0;
+  switch (type) {
+  case FrameCodec::MessageType::Hello:
+    // 服务器的回复：之后的帧都按协商出的版本发送（不会超过本端的请求）
+    if (m_preferredVersion > FrameCodec::VERSION_1 &&
+        FrameCodec::readHello(payload, size, &version, &features)) {
+      m_protocolVersion = qMin(version, m_preferredVersion);
+      m_peerFeatures = features & FrameCodec::SUPPORTED_FEATURES;
+      qDebug() << "协商协议版本:" << m_protocolVersion;
+      emit protocolNegotiated(m_protocolVersion);
+    }
+    break;
+  case FrameCodec::MessageType::Ping:
+    // 原样回显服务器的时间戳
+    if (FrameCodec::readTimestamp(payload, size, &timestampNs)) {
+      writeControlFrame(FrameCodec::packPong(timestampNs, m_protocolVersion));
+    }
+    break;
+  case FrameCodec::MessageType::Pong:
+    if (FrameCodec::readTimestamp(payload, size, &timestampNs)) {
+      const qint64 sampleNs = RttEstimator::nowNs() - timestampNs;
+      if (sampleNs >= 0) {
+        m_rtt.addSample(sampleNs);
+        emit rttMeasured(sampleNs);
+      }
+    }
+    break;
+  case FrameCodec::MessageType::Goodbye:
+    // 服务器正在优雅关闭，之后不会再有数据；连接由服务器关闭
+    qDebug() << "服务器即将关闭连接";
+    emit serverGoingAway();
+    break;
+  default:
+    // 未知类型的控制帧直接忽略，便于以后扩展
+    NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+        << "忽略未知控制帧类型:" << static_cast<int>(type);
+    break;
+  }
+}
+
+void TCPClient::writeControlFrame(const QByteArray &packet) {
+  if (m_socket->state() != QAbstractSocket::ConnectedState) {
+    return;
+  }
+
+  m_socket->write(packet);
+  m_socket->flush();
+}
+
+void TCPClient::dispatchData(const QByteArray &data) {
+  emit dataReceived(data);
+
+  // 字符串接口是二进制接口之上的薄封装：只有在有接收者时才做 UTF-8 解码
+  static const QMetaMethod messageReceivedSignal =
+      QMetaMethod::fromSignal(&TCPClient::messageReceived);
+  if (isSignalConnected(messageReceivedSignal)) {
+    emit messageReceived(QString::fromUtf8(data));
+  }
+}
@@ -1,8 +1,14 @@
 #ifndef TCPCLIENT_H
 #define TCPCLIENT_H
 
+#include "ChunkAssembler.h"
+#include "FrameCodec.h"
+#include "FrameCompression.h"
+#include "Heartbeat.h"
+#include "NetLog.h"
+#include "ReceiveBuffer.h"
+#include "WriteCoalescer.h"
 #include <QByteArray>
-#include <QDataStream>
 #include <QObject>
 #include <QString>
 #include <QTcpSocket>
@@ -14,9 +20,14 @@
  * 功能特性：
  * - 连接到 TCP 服务器
  * - 自动处理 TCP 黏包和半包问题
- * - 消息格式：[4字节长度(大端)][UTF-8消息内容]
+ * - 消息格式：v1 为 [4字节长度(大端)][消息内容]，可选与服务器协商 v2（见 FrameCodec）
+ * - 提供二进制接口（sendData/dataReceived），字符串接口只是其上的 UTF-8 封装
  * - 使用网络字节序（大端）保证跨平台兼容性
  * - 支持自动重连机制
+ * - 可选写合并：同一事件循环迭代内的出站帧合并为一次写入
+ * - 可选压缩：协商出 v2 且服务器支持时，超过阈值的数据帧压缩后发送
+ * - 分块消息：协商出 v2 后可逐块发送任意长度的消息，接收时可流式逐块交付
+ * - 可选心跳：定时发送 Ping 测量 RTT，对端失联时中止连接（可触发自动重连）
  *
  * 线程安全：
  * - 此类使用单线程事件驱动模型，不是线程安全的
@@ -38,9 +49,17 @@ public:
   // 断开连接
   void disconnectFromServer();
 
-  // 发送消息（自动处理黏包和大小端）
+  // 发送二进制数据（自动处理黏包和大小端）
+  void sendData(const QByteArray &data);
+
+  // 发送消息（UTF-8 编码后调用 sendData）
   void sendMessage(const QString &message);
 
+  // 发送分块消息的一块（超过 MAX_CHUNK_SIZE 时自动拆分，last 表示消息结束）。
+  // 同一条消息的各块使用同一个 streamId，消息总长度不受 10MB 限制；
+  // 需要协商出 v2（见 setProtocolVersion），否则报错并丢弃
+  void sendChunk(quint32 streamId, const QByteArray &data, bool last);
+
   // 获取连接状态
   bool isConnected() const;
 
@@ -50,13 +69,56 @@ public:
   // 设置重连间隔（毫秒）
   void setReconnectInterval(int msec);
 
+  // 设置写合并配置（关闭时会先写出已缓存的数据）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 立即写出写合并缓存的所有数据
+  void flushPendingWrites();
+
+  // 设置心跳（间隔为 0 表示不发送 Ping；对端的 Ping 总是会应答）
+  void setHeartbeat(const HeartbeatOptions &options);
+
+  // 平滑后的 RTT（纳秒），尚未测得时为 0
+  qint64 smoothedRttNs() const { return m_rtt.smoothedNs(); }
+
+  // 设置希望使用的最高协议版本（下次连接时生效）。大于 1 时连接后发送 Hello
+  // 协商，服务器回复之前和不支持时都使用 v1。默认 1：旧服务器不认识控制帧
+  void setProtocolVersion(int version);
+
+  // 当前连接使用的协议版本
+  int protocolVersion() const { return m_protocolVersion; }
+
+  // 设置数据帧压缩（需要协商出 v2，见 setProtocolVersion；默认关闭）
+  void setCompression(const CompressionOptions &options);
+
+  // 设置是否流式接收分块消息：开启时每块到达后立即发出 messageChunk；
+  // 关闭时（默认）拼接为完整消息后发出 dataReceived（只影响之后开始的流）
+  void setStreamingReceive(bool enabled) { m_chunks.setStreaming(enabled); }
+
 private:
-  // 打包消息：[4字节长度(大端)][消息内容]
-  static QByteArray packMessage(const QString &message);
+  // 按当前协议版本、服务器特性和压缩配置打包消息
+  QByteArray packMessage(const QByteArray &data) const;
+
+  // 写出一个数据包（写合并模式下先缓存）
+  void writePacket(const QByteArray &packet);
+
+  // 处理一个分块帧，返回 false 表示协议错误（已断开连接）
+  bool handleChunkFrame(const FrameCodec::FrameHeader &header,
+                        const char *payload);
 
   // 解析接收到的数据，处理黏包和半包
   void parseReceivedData();
 
+  // 分发接收到的数据（按需解码为字符串）
+  void dispatchData(const QByteArray &data);
+
+  // 处理控制帧（接受 Hello 回复，应答 Ping，根据 Pong 更新 RTT，转发 Goodbye）
+  void handleControlFrame(FrameCodec::MessageType type, const char *payload,
+                          qsizetype size);
+
+  // 直接写出控制帧（不经过写合并）
+  void writeControlFrame(const QByteArray &packet);
+
 signals:
   // 连接成功
   void connected();
@@ -64,15 +126,32 @@ signals:
   // 断开连接
   void disconnected();
 
-  // 接收到消息
+  // 接收到二进制数据
+  void dataReceived(const QByteArray &data);
+
+  // 接收到消息（UTF-8 解码，仅在有接收者连接时才解码）
   void messageReceived(const QString &message);
 
+  // 流式接收模式下收到分块消息的一块（按顺序，offset 为本块在消息中的偏移）
+  void messageChunk(quint32 streamId, qint64 offset, const QByteArray &data,
+                    bool last);
+
   // 错误信息
   void errorOccurred(const QString &error);
 
   // 正在重连
   void reconnecting();
 
+  // 测得新的 RTT 样本（纳秒，平滑值见 smoothedRttNs）
+  void rttMeasured(qint64 rttNs);
+
+  // 与服务器协商出协议版本
+  void protocolNegotiated(int version);
+
+  // 服务器正在优雅关闭（收到 Goodbye，之前发出的数据都已收到），
+  // 连接随后由服务器关闭；需要协商出 v2
+  void serverGoingAway();
+
 private slots:
   // 处理连接成功
   void onConnected();
@@ -89,10 +168,25 @@ private slots:
   // 尝试重连
   void attemptReconnect();
 
+  // 发送 Ping，连续未应答的 Ping 达到上限时判定服务器失联
+  void sendHeartbeat();
+
 private:
   QTcpSocket *m_socket;
   QTimer *m_reconnectTimer;
-  QByteArray m_receiveBuffer; // 接收缓冲区，处理半包
+  QTimer *m_writeFlushTimer;      // 写合并写出定时器
+  QTimer *m_heartbeatTimer;       // 心跳定时器
+  WriteCoalescer m_writeCoalescer; // 写合并缓存
+  ReceiveBuffer m_receiveBuffer; // 接收缓冲区（读游标），处理半包
+  ChunkAssembler m_chunks;       // 接收中的分块消息
+  LogRateLimiter m_logLimiter;   // 逐消息日志限流
+  HeartbeatOptions m_heartbeat;  // 心跳配置
+  RttEstimator m_rtt;            // RTT 估计
+  int m_unansweredPings;         // 连续未应答的 Ping 数
+  int m_preferredVersion;        // 希望使用的最高协议版本
+  int m_protocolVersion;         // 当前连接使用的协议版本
+  quint8 m_peerFeatures;         // 协商出的服务器特性
+  CompressionOptions m_compression; // 压缩配置
   QString m_host;
 
   int m_reconnectInterval;
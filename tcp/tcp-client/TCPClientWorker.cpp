@@ -1,6 +1,7 @@
 #include "TCPClientWorker.h"
 #include "TCPClient.h"
 #include <QDebug>
+#include <QMetaMethod>
 
 TCPClientWorker::TCPClientWorker(QObject *parent)
     : QObject(parent), m_workerThread(new QThread(this)), m_client(nullptr),
@@ -29,12 +30,21 @@ TCPClientWorker::TCPClientWorker(QObject *parent)
       },
       Qt::QueuedConnection);
 
-  connect(m_client, &TCPClient::messageReceived, this,
-          &TCPClientWorker::messageReceived, Qt::QueuedConnection);
+  // 只转发二进制数据，字符串解码在本线程按需进行
+  connect(m_client, &TCPClient::dataReceived, this,
+          &TCPClientWorker::dispatchData, Qt::QueuedConnection);
+  connect(m_client, &TCPClient::messageChunk, this,
+          &TCPClientWorker::messageChunk, Qt::QueuedConnection);
   connect(m_client, &TCPClient::errorOccurred, this,
           &TCPClientWorker::errorOccurred, Qt::QueuedConnection);
   connect(m_client, &TCPClient::reconnecting, this,
           &TCPClientWorker::reconnecting, Qt::QueuedConnection);
+  connect(m_client, &TCPClient::rttMeasured, this,
+          &TCPClientWorker::rttMeasured, Qt::QueuedConnection);
+  connect(m_client, &TCPClient::protocolNegotiated, this,
+          &TCPClientWorker::protocolNegotiated, Qt::QueuedConnection);
+  connect(m_client, &TCPClient::serverGoingAway, this,
+          &TCPClientWorker::serverGoingAway, Qt::QueuedConnection);
 
   // 线程启动时初始化
   connect(m_workerThread, &QThread::started, this,
@@ -73,10 +83,25 @@ void TCPClientWorker::disconnectFromServer() {
       Qt::QueuedConnection);
 }
 
+void TCPClientWorker::sendData(const QByteArray &data) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, data]() { m_client->sendData(data); },
+      Qt::QueuedConnection);
+}
+
 void TCPClientWorker::sendMessage(const QString &message) {
+  sendData(message.toUtf8());
+}
+
+void TCPClientWorker::sendChunk(quint32 streamId, const QByteArray &data,
+                                bool last) {
   // 线程安全：通过队列连接调用
   QMetaObject::invokeMethod(
-      m_client, [this, message]() { m_client->sendMessage(message); },
+      m_client,
+      [this, streamId, data, last]() {
+        m_client->sendChunk(streamId, data, last);
+      },
       Qt::QueuedConnection);
 }
 
@@ -99,7 +124,54 @@ void TCPClientWorker::setReconnectInterval(int msec) {
       Qt::QueuedConnection);
 }
 
+void TCPClientWorker::setWriteCoalescing(
+    const WriteCoalescingOptions &options) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, options]() { m_client->setWriteCoalescing(options); },
+      Qt::QueuedConnection);
+}
+
+void TCPClientWorker::setHeartbeat(const HeartbeatOptions &options) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, options]() { m_client->setHeartbeat(options); },
+      Qt::QueuedConnection);
+}
+
+void TCPClientWorker::setProtocolVersion(int version) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, version]() { m_client->setProtocolVersion(version); },
+      Qt::QueuedConnection);
+}
+
+void TCPClientWorker::setCompression(const CompressionOptions &options) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, options]() { m_client->setCompression(options); },
+      Qt::QueuedConnection);
+}
+
+void TCPClientWorker::setStreamingReceive(bool enabled) {
+  // 线程安全：通过队列连接调用
+  QMetaObject::invokeMethod(
+      m_client, [this, enabled]() { m_client->setStreamingReceive(enabled); },
+      Qt::QueuedConnection);
+}
+
 void TCPClientWorker::initializeClient() {
   // 工作线程启动时的初始化（如果需要）
   qDebug() << "[TCPClientWorker] 工作线程已启动:" << QThread::currentThread();
 }
+
+void TCPClientWorker::dispatchData(const QByteArray &data) {
+  emit dataReceived(data);
+
+  // 只有在有接收者时才做 UTF-8 解码
+  static const QMetaMethod messageReceivedSignal =
+      QMetaMethod::fromSignal(&TCPClientWorker::messageReceived);
+  if (isSignalConnected(messageReceivedSignal)) {
+    emit messageReceived(QString::fromUtf8(data));
+  }
+}
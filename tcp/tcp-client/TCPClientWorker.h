@@ -1,6 +1,10 @@
 #ifndef TCPCLIENTWORKER_H
 #define TCPCLIENTWORKER_H
 
+#include "FrameCompression.h"
+#include "Heartbeat.h"
+#include "WriteCoalescer.h"
+#include <QByteArray>
 #include <QObject>
 #include <QString>
 #include <QThread>
@@ -35,9 +39,15 @@ public:
   // 断开连接（线程安全）
   void disconnectFromServer();
 
-  // 发送消息（线程安全）
+  // 发送二进制数据（线程安全）
+  void sendData(const QByteArray &data);
+
+  // 发送消息（线程安全，UTF-8 编码后调用 sendData）
   void sendMessage(const QString &message);
 
+  // 发送分块消息的一块（线程安全）
+  void sendChunk(quint32 streamId, const QByteArray &data, bool last);
+
   // 获取连接状态（线程安全）
   bool isConnected() const;
 
@@ -47,6 +57,21 @@ public:
   // 设置重连间隔（毫秒）（线程安全）
   void setReconnectInterval(int msec);
 
+  // 设置写合并配置（线程安全）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 设置心跳配置（线程安全）
+  void setHeartbeat(const HeartbeatOptions &options);
+
+  // 设置希望使用的最高协议版本，下次连接时生效（线程安全）
+  void setProtocolVersion(int version);
+
+  // 设置数据帧压缩配置（线程安全）
+  void setCompression(const CompressionOptions &options);
+
+  // 设置是否流式接收分块消息（线程安全）
+  void setStreamingReceive(bool enabled);
+
 signals:
   // 连接成功
   void connected();
@@ -54,19 +79,38 @@ signals:
   // 断开连接
   void disconnected();
 
-  // 接收到消息
+  // 接收到二进制数据
+  void dataReceived(const QByteArray &data);
+
+  // 接收到消息（UTF-8 解码，仅在有接收者连接时才解码）
   void messageReceived(const QString &message);
 
+  // 流式接收模式下收到分块消息的一块
+  void messageChunk(quint32 streamId, qint64 offset, const QByteArray &data,
+                    bool last);
+
   // 错误信息
   void errorOccurred(const QString &error);
 
   // 正在重连
   void reconnecting();
 
+  // 测得新的 RTT 样本（纳秒）
+  void rttMeasured(qint64 rttNs);
+
+  // 与服务器协商出协议版本
+  void protocolNegotiated(int version);
+
+  // 服务器正在优雅关闭
+  void serverGoingAway();
+
 private slots:
   // 初始化工作线程中的 TCPClient
   void initializeClient();
 
+  // 分发接收到的数据（按需解码为字符串）
+  void dispatchData(const QByteArray &data);
+
 private:
   QThread *m_workerThread; // 工作线程
   TCPClient *m_client;     // TCP 客户端（在工作线程中）
@@ -0,0 +1,52 @@
+#include "ChunkAssembler.h"
+#include "FrameCodec.h"
+
+ChunkAssembler::Result ChunkAssembler::feed(quint32 streamId,
+                                            const char *chunk, qsizetype size,
+                                            bool last, qint64 *offset,
+                                            QByteArray *data) {
+  auto it = m_streams.find(streamId);
+  if (it == m_streams.end()) {
+    if (m_streams.size() >= MAX_STREAMS) {
+      return Result::Error;
+    }
+    Stream stream;
+    stream.streaming = m_streaming;
+    it = m_streams.insert(streamId, stream);
+  }
+
+  Stream &stream = it.value();
+  *offset = stream.received;
+  stream.received += size;
+
+  // 流式模式：不缓存，直接交给上层
+  if (stream.streaming) {
+    *data = QByteArray(chunk, size);
+    if (last) {
+      m_streams.erase(it);
+    }
+    return Result::Chunk;
+  }
+
+  // 非流式模式：拼接，总缓存量有上限
+  if (m_bufferedBytes + size > FrameCodec::MAX_MESSAGE_SIZE) {
+    m_bufferedBytes -= stream.buffer.size();
+    m_streams.erase(it);
+    return Result::Error;
+  }
+  stream.buffer.append(chunk, size);
+  m_bufferedBytes += size;
+  if (!last) {
+    return Result::Pending;
+  }
+
+  m_bufferedBytes -= stream.buffer.size();
+  *data = std::move(stream.buffer);
+  m_streams.erase(it);
+  return Result::Message;
+}
+
+void ChunkAssembler::clear() {
+  m_streams.clear();
+  m_bufferedBytes = 0;
+}
@@ -0,0 +1,61 @@
+#ifndef CHUNKASSEMBLER_H
+#define CHUNKASSEMBLER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QtGlobal>
+
+/**
+ * @brief 分块消息的接收端状态（客户端和服务器共用）
+ *
+ * 功能特性：
+ * - 流式模式：每块到达后立即交给上层，只记录每个流已接收的字节数（偏移），
+ *   不缓存内容，峰值内存只有一块（不超过 FrameCodec::MAX_CHUNK_SIZE）
+ * - 非流式模式：把各块拼接为完整消息，最后一块到达时作为普通消息交给上层，
+ *   所有流缓存的总字节数不超过 FrameCodec::MAX_MESSAGE_SIZE
+ * - 模式在流开始时确定，中途切换只影响之后开始的流
+ * - 同时进行中的流不超过 MAX_STREAMS 个
+ *
+ * 线程安全：
+ * - 此类不是线程安全的，只能在所属连接的线程中使用
+ */
+class ChunkAssembler {
+public:
+  static constexpr int MAX_STREAMS = 64;
+
+  // 处理一块的结果
+  enum class Result {
+    Chunk,   // 流式模式：本块应立即交给上层（offset 和 data 已填写）
+    Message, // 非流式模式：消息已完整（data 为整条消息）
+    Pending, // 非流式模式：已缓存，等待后续块
+    Error,   // 流过多或缓存超过上限，应断开连接
+  };
+
+  // 设置是否流式交付（只影响之后开始的流）
+  void setStreaming(bool enabled) { m_streaming = enabled; }
+
+  bool isStreaming() const { return m_streaming; }
+
+  // 处理一块数据
+  Result feed(quint32 streamId, const char *chunk, qsizetype size, bool last,
+              qint64 *offset, QByteArray *data);
+
+  // 进行中的流数
+  int activeStreams() const { return static_cast<int>(m_streams.size()); }
+
+  // 丢弃所有进行中的流（连接断开时调用）
+  void clear();
+
+private:
+  struct Stream {
+    qint64 received = 0;    // 已接收的字节数（下一块的偏移）
+    QByteArray buffer;      // 非流式模式下已拼接的内容
+    bool streaming = false; // 流开始时的模式
+  };
+
+  QHash<quint32, Stream> m_streams; // 进行中的流
+  qint64 m_bufferedBytes = 0;       // 非流式模式下缓存的总字节数
+  bool m_streaming = false;         // 新流是否流式交付
+};
+
+#endif // CHUNKASSEMBLER_H
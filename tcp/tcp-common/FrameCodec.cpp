@@ -0,0 +1,250 @@
+#include "FrameCodec.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+constexpr qsizetype V2_FIXED_SIZE = 2;      // 类型字节 + 标志字节
+constexpr qsizetype HELLO_PAYLOAD_SIZE = 2; // [版本][特性]
+
+// 内容长度的 LEB128 编码字节数
+qsizetype varintSize(quint32 value) {
+  qsizetype size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+// 写入 LEB128 编码，返回写入后的位置
+char *writeVarint(char *out, quint32 value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<char>(value);
+  return out;
+}
+
+// 不同类型的内容上限
+quint32 maxPayloadSize(FrameCodec::MessageType type) {
+  switch (type) {
+  case FrameCodec::MessageType::Data:
+    return FrameCodec::MAX_MESSAGE_SIZE;
+  case FrameCodec::MessageType::Chunk:
+    return FrameCodec::CHUNK_ID_SIZE + FrameCodec::MAX_CHUNK_SIZE;
+  default:
+    return FrameCodec::MAX_CONTROL_SIZE;
+  }
+}
+
+QByteArray packTimestamp(FrameCodec::MessageType type, qint64 timestampNs,
+                         int version) {
+  char payload[sizeof(qint64)];
+  qToBigEndian(timestampNs, payload);
+  return FrameCodec::packFrame(version, type, 0, payload, sizeof(payload));
+}
+} // namespace
+
+FrameCodec::DecodeStatus FrameCodec::decodeHeader(const char *data,
+                                                  qsizetype size,
+                                                  FrameHeader *header) {
+  if (size < 1) {
+    return DecodeStatus::NeedMore;
+  }
+
+  const quint8 first = static_cast<quint8>(data[0]);
+  if ((first & V2_MARKER_MASK) == V2_MARKER) {
+    // v2：[类型][标志][变长长度]
+    if (size < V2_FIXED_SIZE + 1) {
+      return DecodeStatus::NeedMore;
+    }
+    header->version = VERSION_2;
+    header->type = static_cast<MessageType>(first & V2_TYPE_MASK);
+    header->flags = static_cast<quint8>(data[1]);
+    if ((header->flags & ~KNOWN_FLAGS) != 0) {
+      return DecodeStatus::Invalid;
+    }
+
+    quint64 length = 0;
+    qsizetype pos = V2_FIXED_SIZE;
+    for (int shift = 0;; shift += 7) {
+      if (pos - V2_FIXED_SIZE >= MAX_VARINT_SIZE) {
+        return DecodeStatus::Invalid;
+      }
+      if (pos >= size) {
+        return DecodeStatus::NeedMore;
+      }
+      const quint8 byte = static_cast<quint8>(data[pos++]);
+      length |= static_cast<quint64>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    if (length > maxPayloadSize(header->type)) {
+      return DecodeStatus::Invalid;
+    }
+    header->headerSize = pos;
+    header->payloadSize = static_cast<quint32>(length);
+    return DecodeStatus::Ok;
+  }
+
+  // v1：[4字节头]，控制帧内容的第一个字节是类型
+  if (size < HEADER_SIZE) {
+    return DecodeStatus::NeedMore;
+  }
+  const quint32 raw = qFromBigEndian<quint32>(data);
+  const quint32 length = raw & ~CONTROL_FLAG;
+  header->version = VERSION_1;
+  header->flags = 0;
+  if ((raw & CONTROL_FLAG) == 0) {
+    if (length > MAX_MESSAGE_SIZE) {
+      return DecodeStatus::Invalid;
+    }
+    header->type = MessageType::Data;
+    header->headerSize = HEADER_SIZE;
+    header->payloadSize = length;
+    return DecodeStatus::Ok;
+  }
+
+  if (length < 1 || length > MAX_CONTROL_SIZE) {
+    return DecodeStatus::Invalid;
+  }
+  if (size < HEADER_SIZE + 1) {
+    return DecodeStatus::NeedMore;
+  }
+  header->type = static_cast<MessageType>(data[HEADER_SIZE]);
+  header->headerSize = HEADER_SIZE + 1;
+  header->payloadSize = length - 1;
+  return DecodeStatus::Ok;
+}
+
+QByteArray FrameCodec::packFrame(int version, MessageType type, quint8 flags,
+                                 const char *payload, qsizetype size) {
+  const quint32 length = static_cast<quint32>(size);
+
+  // 一次分配到位，直接写入帧头，避免构造 QDataStream
+  QByteArray packet;
+  char *out = nullptr;
+  if (version >= VERSION_2) {
+    packet = QByteArray(V2_FIXED_SIZE + varintSize(length) + size,
+                        Qt::Uninitialized);
+    out = packet.data();
+    *out++ = static_cast<char>(V2_MARKER | static_cast<quint8>(type));
+    *out++ = static_cast<char>(flags);
+    out = writeVarint(out, length);
+  } else if (type == MessageType::Data) {
+    packet = QByteArray(HEADER_SIZE + size, Qt::Uninitialized);
+    out = packet.data();
+    qToBigEndian(length, out);
+    out += HEADER_SIZE;
+  } else {
+    packet = QByteArray(HEADER_SIZE + 1 + size, Qt::Uninitialized);
+    out = packet.data();
+    qToBigEndian(CONTROL_FLAG | (length + 1), out);
+    out[HEADER_SIZE] = static_cast<char>(type);
+    out += HEADER_SIZE + 1;
+  }
+  if (size > 0) {
+    memcpy(out, payload, static_cast<size_t>(size));
+  }
+  return packet;
+}
+
+QByteArray FrameCodec::packData(const QByteArray &data, int version) {
+  return packFrame(version, MessageType::Data, 0, data.constData(),
+                   data.size());
+}
+
+QByteArray FrameCodec::packPing(qint64 timestampNs, int version) {
+  return packTimestamp(MessageType::Ping, timestampNs, version);
+}
+
+QByteArray FrameCodec::packPong(qint64 timestampNs, int version) {
+  return packTimestamp(MessageType::Pong, timestampNs, version);
+}
+
+QByteArray FrameCodec::packChunk(quint32 streamId, const char *data,
+                                 qsizetype size, bool last) {
+  // 流 ID 和本块数据直接写入帧，不拼接临时缓冲区
+  const quint32 length = static_cast<quint32>(CHUNK_ID_SIZE + size);
+  QByteArray packet(V2_FIXED_SIZE + varintSize(length) + length,
+                    Qt::Uninitialized);
+  char *out = packet.data();
+  *out++ = static_cast<char>(V2_MARKER |
+                             static_cast<quint8>(MessageType::Chunk));
+  *out++ = static_cast<char>(last ? FLAG_FINAL : 0);
+  out = writeVarint(out, length);
+  qToBigEndian(streamId, out);
+  if (size > 0) {
+    memcpy(out + CHUNK_ID_SIZE, data, static_cast<size_t>(size));
+  }
+  return packet;
+}
+
+QByteArray FrameCodec::packGoodbye(int version) {
+  return packFrame(version, MessageType::Goodbye, 0, nullptr, 0);
+}
+
+QByteArray FrameCodec::packHello(int version, quint8 features) {
+  const char payload[HELLO_PAYLOAD_SIZE] = {static_cast<char>(version),
+                                            static_cast<char>(features)};
+  return packFrame(VERSION_1, MessageType::Hello, 0, payload,
+                   HELLO_PAYLOAD_SIZE);
+}
+
+bool FrameCodec::readTimestamp(const char *payload, qsizetype size,
+                               qint64 *timestampNs) {
+  if (size < static_cast<qsizetype>(sizeof(qint64))) {
+    return false;
+  }
+  *timestampNs = qFromBigEndian<qint64>(payload);
+  return true;
+}
+
+bool FrameCodec::readChunkStreamId(const char *payload, qsizetype size,
+                                   quint32 *streamId) {
+  if (size < CHUNK_ID_SIZE) {
+    return false;
+  }
+  *streamId = qFromBigEndian<quint32>(payload);
+  return true;
+}
+
+bool FrameCodec::readHello(const char *payload, qsizetype size, int *version,
+                           quint8 *features) {
+  if (size < HELLO_PAYLOAD_SIZE) {
+    return false;
+  }
+  *version = static_cast<quint8>(payload[0]);
+  *features = static_cast<quint8>(payload[1]);
+  return *version >= VERSION_1;
+}
+
+const QByteArray &FrameCodec::PreparedFrame::packet(int version,
+                                                   bool allowCompressed) const {
+  version = qBound(VERSION_1, version, LATEST_VERSION);
+  if (usesCompression(version, allowCompressed)) {
+    if (m_compressedPacket.isNull()) {
+      m_compressedPacket = packFrame(version, MessageType::Data,
+                                     FLAG_COMPRESSED, m_compressed.constData(),
+                                     m_compressed.size());
+    }
+    return m_compressedPacket;
+  }
+
+  QByteArray &cached = m_packets[version - 1];
+  if (cached.isNull()) {
+    cached = packData(m_payload, version);
+  }
+  return cached;
+}
+
+void FrameCodec::PreparedFrame::packAll() const {
+  for (int version = VERSION_1; version <= LATEST_VERSION; ++version) {
+    packet(version);
+  }
+  if (!m_compressed.isEmpty()) {
+    packet(VERSION_2, true);
+  }
+}
@@ -0,0 +1,177 @@
+#ifndef FRAMECODEC_H
+#define FRAMECODEC_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QtGlobal>
+
+/**
+ * @brief 帧编解码（客户端和服务器共用）
+ *
+ * v1 帧格式：[4字节头(大端)][内容]
+ * - 数据帧：头的最高位为 0，头即内容长度
+ * - 控制帧：头的最高位为 1，低 31 位为内容长度，内容为 [1字节类型][类型数据]
+ *
+ * v2 帧格式：[1字节类型][1字节标志][变长长度][内容]
+ * - 类型字节的高两位固定为 01，低 6 位为消息类型（MessageType）
+ * - 标志字节：FLAG_COMPRESSED 表示内容经过压缩（见 FrameCompression），
+ *   FLAG_FINAL 表示分块消息的最后一块，其余位保留，必须为 0
+ * - 长度为内容长度的 LEB128 变长编码（每字节 7 位，低位在前），
+ *   127 字节以内的消息帧头只有 3 字节
+ *
+ * v1 帧头的第一个字节只可能是 0x00（数据帧不超过 10MB）或 0x80（控制帧），
+ * 因此解码器按第一个字节区分两种版本，协商切换前后的帧可以混在同一个流中。
+ *
+ * 版本协商：客户端连接后用 v1 控制帧发送 Hello（[1字节最高版本][1字节特性]），
+ * 服务器取双方都支持的最高版本和共同的特性，同样用 v1 控制帧回复 Hello，
+ * 此后双方各自改用协商出的版本发送。不认识 Hello 的 v1 对端会忽略它，
+ * 连接保持 v1。特性位声明本端能解码的内容，例如 FEATURE_COMPRESSION。
+ *
+ * 分块消息（仅 v2）：内容为 [4字节流 ID(大端)][本块数据]，同一个流的各块按顺序
+ * 发送，最后一块带 FLAG_FINAL。每块不超过 MAX_CHUNK_SIZE，消息总长度不受
+ * MAX_MESSAGE_SIZE 限制；各块都是完整的帧，其他消息和控制帧可以穿插其间。
+ *
+ * Ping/Pong：类型数据为 8 字节发送方时间戳（纳秒，大端），Pong 原样回显
+ * Ping 的时间戳，发送方用当前时间减去回显值得到往返时延（RTT）。
+ *
+ * Goodbye：服务器优雅关闭（drain）时发给协商过版本的连接，排在已排队的数据之后，
+ * 之后不会再有数据；客户端可以据此准备重连。
+ *
+ * 旧版本的对端会把控制帧当作超长消息而断开连接，因此心跳和版本协商默认关闭，
+ * 两端都升级后再启用。
+ */
+namespace FrameCodec {
+constexpr qsizetype HEADER_SIZE = sizeof(quint32);     // v1 帧头长度
+constexpr quint32 MAX_MESSAGE_SIZE = 10 * 1024 * 1024; // 数据帧 10MB 上限
+constexpr quint32 MAX_CONTROL_SIZE = 1024;             // 控制帧内容上限
+constexpr quint32 MAX_CHUNK_SIZE = 256 * 1024;         // 分块消息每块数据上限
+constexpr qsizetype CHUNK_ID_SIZE = sizeof(quint32);   // 分块帧中的流 ID
+constexpr quint32 CONTROL_FLAG = 0x80000000u;          // v1 控制帧标志位
+
+constexpr int VERSION_1 = 1;              // 固定 4 字节长度头
+constexpr int VERSION_2 = 2;              // 类型字节 + 标志字节 + 变长长度
+constexpr int LATEST_VERSION = VERSION_2; // 本端支持的最高版本
+
+constexpr quint8 V2_MARKER = 0x40; // v2 类型字节的高两位
+constexpr quint8 V2_MARKER_MASK = 0xC0;
+constexpr quint8 V2_TYPE_MASK = 0x3F;
+constexpr quint8 FLAG_COMPRESSED = 0x01; // 内容经过压缩
+constexpr quint8 FLAG_FINAL = 0x02;      // 分块消息的最后一块
+constexpr quint8 KNOWN_FLAGS = FLAG_COMPRESSED | FLAG_FINAL; // 已定义的标志位
+constexpr qsizetype MAX_VARINT_SIZE = 5; // 32 位长度的 LEB128 最多 5 字节
+
+constexpr quint8 FEATURE_COMPRESSION = 0x01; // Hello 特性位：能解码压缩帧
+constexpr quint8 FEATURE_CHUNKS = 0x02;      // Hello 特性位：能接收分块消息
+constexpr quint8 SUPPORTED_FEATURES =
+    FEATURE_COMPRESSION | FEATURE_CHUNKS; // 本端支持的特性
+
+// 消息类型（v1 控制帧的类型字节、v2 类型字节的低 6 位）
+enum class MessageType : quint8 {
+  Data = 0,  // 数据消息（v1 中是普通数据帧）
+  Ping = 1,  // 心跳请求
+  Pong = 2,  // 心跳应答（回显时间戳）
+  Hello = 3, // 版本协商
+  Chunk = 4, // 分块消息的一块（仅 v2）
+  Goodbye = 5, // 服务器即将关闭，之后不再发送数据（无类型数据）
+};
+
+// 帧头解码结果
+enum class DecodeStatus {
+  Ok,       // 帧头完整且合法（内容可能还没有全部到达）
+  NeedMore, // 帧头还不完整
+  Invalid,  // 帧头非法或内容超过上限，应断开连接
+};
+
+// 解码后的帧头
+struct FrameHeader {
+  int version = VERSION_1;
+  MessageType type = MessageType::Data;
+  quint8 flags = 0;
+  qsizetype headerSize = 0; // 从帧起始到内容的字节数（v1 控制帧含类型字节）
+  quint32 payloadSize = 0;  // 内容长度（不含类型字节）
+
+  // 整帧长度
+  qsizetype frameSize() const { return headerSize + payloadSize; }
+};
+
+// 按第一个字节识别版本并解码帧头
+DecodeStatus decodeHeader(const char *data, qsizetype size,
+                          FrameHeader *header);
+
+// 按指定版本打包一帧（v1 忽略标志位）
+QByteArray packFrame(int version, MessageType type, quint8 flags,
+                     const char *payload, qsizetype size);
+
+// 打包数据帧（一次分配到位）
+QByteArray packData(const QByteArray &data, int version = VERSION_1);
+
+// 打包 Ping/Pong 控制帧
+QByteArray packPing(qint64 timestampNs, int version = VERSION_1);
+QByteArray packPong(qint64 timestampNs, int version = VERSION_1);
+
+// 打包分块消息的一块（v2 帧，size 不超过 MAX_CHUNK_SIZE）
+QByteArray packChunk(quint32 streamId, const char *data, qsizetype size,
+                     bool last);
+
+// 打包 Goodbye 控制帧
+QByteArray packGoodbye(int version);
+
+// 打包 Hello（总是 v1 控制帧，协商完成之前双方都能解码）
+QByteArray packHello(int version, quint8 features);
+
+// 解析 Ping/Pong 内容中的时间戳，格式不对返回 false
+bool readTimestamp(const char *payload, qsizetype size, qint64 *timestampNs);
+
+// 解析分块帧内容中的流 ID，格式不对返回 false（本块数据从 CHUNK_ID_SIZE 开始）
+bool readChunkStreamId(const char *payload, qsizetype size, quint32 *streamId);
+
+// 解析 Hello 内容，格式不对返回 false
+bool readHello(const char *payload, qsizetype size, int *version,
+               quint8 *features);
+
+/**
+ * @brief 按需打包的广播帧
+ *
+ * 同一条消息要发给协商出不同版本的多个连接时，每个版本只打包一次，
+ * 之后的连接共享同一个 QByteArray（隐式共享）。压缩内容在构造前只压缩一次，
+ * 所有支持压缩的连接共享。
+ * 打包缓存不加锁：跨线程前先在调用线程上 packAll()，再按值传递，
+ * 各线程的副本共享已打包的帧；不要在线程间共享同一个对象。
+ */
+class PreparedFrame {
+public:
+  PreparedFrame() = default;
+
+  // compressed 为 FrameCompression::compress 的结果，为空表示不压缩
+  explicit PreparedFrame(const QByteArray &payload,
+                         const QByteArray &compressed = QByteArray())
+      : m_payload(payload), m_compressed(compressed) {}
+
+  // 原始内容
+  const QByteArray &payload() const { return m_payload; }
+
+  // 压缩后的内容（没有压缩时为空）
+  const QByteArray &compressed() const { return m_compressed; }
+
+  // packet(version, allowCompressed) 是否返回压缩帧（只有 v2 帧能携带压缩标志）
+  bool usesCompression(int version, bool allowCompressed) const {
+    return allowCompressed && version >= VERSION_2 && !m_compressed.isEmpty();
+  }
+
+  // 指定版本的数据帧（第一次调用时打包）；allowCompressed 表示对端能解码压缩帧
+  const QByteArray &packet(int version, bool allowCompressed = false) const;
+
+  // 打包所有版本的数据帧（有压缩内容时包括压缩帧），之后的副本不再打包
+  void packAll() const;
+
+private:
+  QByteArray m_payload;
+  QByteArray m_compressed;
+  mutable QByteArray m_packets[LATEST_VERSION]; // 按版本缓存的普通数据帧
+  mutable QByteArray m_compressedPacket;        // 压缩数据帧（只有 v2 支持）
+};
+} // namespace FrameCodec
+
+Q_DECLARE_METATYPE(FrameCodec::PreparedFrame)
+
+#endif // FRAMECODEC_H
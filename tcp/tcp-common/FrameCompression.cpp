@@ -0,0 +1,38 @@
+#include "FrameCompression.h"
+#include "FrameCodec.h"
+#include <QtEndian>
+
+namespace {
+constexpr qsizetype LENGTH_PREFIX_SIZE = sizeof(quint32); // qCompress 的长度前缀
+} // namespace
+
+QByteArray FrameCompression::compress(const QByteArray &data,
+                                      const CompressionOptions &options) {
+  if (options.thresholdBytes <= 0 || data.size() < options.thresholdBytes) {
+    return QByteArray();
+  }
+
+  QByteArray compressed = qCompress(data, qBound(1, options.level, 9));
+
+  // 不可压缩的内容（已压缩的图片等）按原样发送
+  if (compressed.size() >= data.size()) {
+    return QByteArray();
+  }
+  return compressed;
+}
+
+bool FrameCompression::decompress(const char *data, qsizetype size,
+                                  QByteArray *out) {
+  if (size <= LENGTH_PREFIX_SIZE) {
+    return false;
+  }
+
+  // 先检查声明的原始长度，防止压缩炸弹
+  const quint32 originalSize = qFromBigEndian<quint32>(data);
+  if (originalSize > FrameCodec::MAX_MESSAGE_SIZE) {
+    return false;
+  }
+
+  *out = qUncompress(reinterpret_cast<const uchar *>(data), size);
+  return out->size() == static_cast<qsizetype>(originalSize);
+}
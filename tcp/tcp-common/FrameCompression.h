@@ -0,0 +1,31 @@
+#ifndef FRAMECOMPRESSION_H
+#define FRAMECOMPRESSION_H
+
+#include <QByteArray>
+#include <QMetaType>
+#include <QtGlobal>
+
+// 数据帧压缩配置（只对协商出 v2 且对端声明支持压缩的连接生效）
+struct CompressionOptions {
+  int thresholdBytes = 0; // 内容达到该大小才压缩，0 表示不压缩
+  int level = 1;          // zlib 压缩级别（1 最快，9 压缩率最高）
+};
+
+Q_DECLARE_METATYPE(CompressionOptions)
+
+/**
+ * @brief 数据帧内容的压缩与解压（客户端和服务器共用）
+ *
+ * 使用 zlib（qCompress/qUncompress），压缩后的内容为
+ * [4字节原始长度(大端)][zlib 数据]，帧头带 FrameCodec::FLAG_COMPRESSED 标志。
+ * 解压前先检查原始长度，超过消息上限的帧直接拒绝，不会按对端声明的长度分配内存。
+ */
+namespace FrameCompression {
+// 按配置压缩；未达到阈值或压缩后没有变小时返回空 QByteArray
+QByteArray compress(const QByteArray &data, const CompressionOptions &options);
+
+// 解压带压缩标志的帧内容，格式错误或超过消息上限时返回 false
+bool decompress(const char *data, qsizetype size, QByteArray *out);
+} // namespace FrameCompression
+
+#endif // FRAMECOMPRESSION_H
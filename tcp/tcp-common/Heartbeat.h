@@ -0,0 +1,53 @@
+#ifndef HEARTBEAT_H
+#define HEARTBEAT_H
+
+#include <QMetaType>
+#include <QtGlobal>
+#include <chrono>
+
+// 心跳配置
+struct HeartbeatOptions {
+  int intervalMs = 0; // 发送 Ping 的间隔，0 表示不发送
+  int maxMissed = 3;  // 连续未应答的 Ping 达到该数量时判定对端失联
+};
+
+Q_DECLARE_METATYPE(HeartbeatOptions)
+
+/**
+ * @brief 往返时延（RTT）估计
+ *
+ * 与 TCP 的 SRTT 相同：新样本以 1/8 的权重并入平滑值（EWMA），
+ * 第一个样本直接作为初始值。
+ */
+class RttEstimator {
+public:
+  // 单调时钟纳秒数（Ping 时间戳只由发送方自己解释，不要求两端时钟一致）
+  static qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+
+  // 加入一个样本（纳秒）
+  void addSample(qint64 sampleNs) {
+    m_lastNs = sampleNs;
+    m_smoothedNs = m_smoothedNs == 0
+                       ? sampleNs
+                       : m_smoothedNs + (sampleNs - m_smoothedNs) / 8;
+  }
+
+  // 平滑后的 RTT（纳秒），没有样本时为 0
+  qint64 smoothedNs() const { return m_smoothedNs; }
+
+  // 最近一个样本（纳秒）
+  qint64 lastSampleNs() const { return m_lastNs; }
+
+  // 清除所有样本（重新连接时调用）
+  void reset() { m_smoothedNs = m_lastNs = 0; }
+
+private:
+  qint64 m_smoothedNs = 0;
+  qint64 m_lastNs = 0;
+};
+
+#endif // HEARTBEAT_H
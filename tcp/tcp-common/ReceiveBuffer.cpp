@@ -0,0 +1,137 @@
+#include "ReceiveBuffer.h"
+#include "SlabBufferPool.h"
+#include <algorithm>
+#include <cstring>
+
+// 缩容阈值：容量超过 8KB 且剩余半包小于 1KB 时换成小缓冲区
+constexpr qsizetype SHRINK_THRESHOLD = 8192;
+constexpr qsizetype SHRINK_MAX_REMAINING = 1024;
+
+// 没有缓冲池时的最小分配
+constexpr qsizetype MIN_CAPACITY = 4096;
+
+ReceiveBuffer::ReceiveBuffer(SlabBufferPool *pool)
+    : m_readPos(0), m_pool(pool) {}
+
+ReceiveBuffer::~ReceiveBuffer() { releaseStorage(); }
+
+void ReceiveBuffer::setPool(SlabBufferPool *pool) {
+  if (pool == m_pool) {
+    return;
+  }
+
+  // 保留未读数据：换到新缓冲池的存储上
+  const QByteArray remaining(data(), size());
+  releaseStorage();
+  m_pool = pool;
+  append(remaining.constData(), remaining.size());
+}
+
+qint64 ReceiveBuffer::readFrom(QIODevice *device) {
+  const qint64 available = device->bytesAvailable();
+  if (available <= 0) {
+    return 0;
+  }
+
+  // 直接读入缓冲区尾部，不经过 readAll() 的临时对象
+  ensureTailSpace(static_cast<qsizetype>(available));
+  const qsizetype oldSize = m_data.size();
+  m_data.resize(oldSize + static_cast<qsizetype>(available));
+
+  const qint64 bytesRead =
+      device->read(m_data.data() + oldSize, static_cast<qint64>(available));
+  m_data.resize(oldSize + static_cast<qsizetype>(std::max<qint64>(bytesRead, 0)));
+  return bytesRead;
+}
+
+void ReceiveBuffer::append(const char *data, qsizetype size) {
+  if (size <= 0) {
+    return;
+  }
+  ensureTailSpace(size);
+  m_data.append(data, size);
+}
+
+void ReceiveBuffer::reserveFrame(qsizetype frameSize) {
+  compact();
+  if (m_data.capacity() < frameSize) {
+    replaceStorage(frameSize);
+  }
+}
+
+void ReceiveBuffer::compact() {
+  const qsizetype remaining = size();
+  if (remaining == 0) {
+    if (!m_pool && m_data.capacity() <= SHRINK_THRESHOLD) {
+      // 没有缓冲池：保留小缓冲区给下次读取，只重置游标（容量不变）
+      m_data.truncate(0);
+      m_readPos = 0;
+      return;
+    }
+    // 全部消费完：归还存储，空闲连接不占用缓冲区（没有缓冲池时释放大缓冲区，
+    // 下次读取重新分配最小容量）
+    releaseStorage();
+    return;
+  }
+  if (m_readPos == 0) {
+    return;
+  }
+
+  if (m_data.capacity() > SHRINK_THRESHOLD &&
+      remaining < SHRINK_MAX_REMAINING) {
+    // 容量过大且剩余半包很少：换成小缓冲区
+    replaceStorage(remaining);
+    return;
+  }
+
+  // 把剩余的半包移动到头部
+  std::memmove(m_data.data(), data(), static_cast<size_t>(remaining));
+  m_data.resize(remaining);
+  m_readPos = 0;
+}
+
+void ReceiveBuffer::clear() { releaseStorage(); }
+
+void ReceiveBuffer::ensureTailSpace(qsizetype bytes) {
+  const qsizetype required = m_data.size() + bytes;
+  if (m_data.capacity() >= required) {
+    return;
+  }
+
+  // 游标之前有已消费的数据时，先压缩再判断
+  if (m_readPos > 0) {
+    std::memmove(m_data.data(), data(), static_cast<size_t>(size()));
+    m_data.resize(size());
+    m_readPos = 0;
+    if (m_data.capacity() >= m_data.size() + bytes) {
+      return;
+    }
+  }
+
+  // 按倍数增长（由缓冲池的尺寸级别取整），避免频繁更换存储
+  replaceStorage(std::max(m_data.size() + bytes, m_data.capacity() * 2));
+}
+
+void ReceiveBuffer::replaceStorage(qsizetype capacity) {
+  QByteArray storage = acquireStorage(std::max(capacity, size()));
+  storage.append(data(), size());
+  releaseStorage();
+  m_data = std::move(storage);
+}
+
+QByteArray ReceiveBuffer::acquireStorage(qsizetype capacity) {
+  if (m_pool) {
+    return m_pool->acquire(capacity);
+  }
+  QByteArray storage;
+  storage.reserve(std::max(capacity, MIN_CAPACITY));
+  return storage;
+}
+
+void ReceiveBuffer::releaseStorage() {
+  if (m_data.capacity() > 0 && m_pool) {
+    m_pool->release(std::move(m_data));
+  }
+  m_data = QByteArray();
+  m_readPos = 0;
+}
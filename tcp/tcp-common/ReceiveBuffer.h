@@ -0,0 +1,92 @@
+#ifndef RECEIVEBUFFER_H
+#define RECEIVEBUFFER_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+class SlabBufferPool;
+
+/**
+ * @brief 基于读游标的接收缓冲区
+ *
+ * 设计目的：
+ * - 解析黏包时只移动读游标，不再对每一帧执行 remove(0, n)
+ * - 每次读取最多压缩（compact）一次，把剩余的半包移动到缓冲区头部
+ * - 直接从 QIODevice 读入缓冲区尾部，避免 readAll() 产生的临时 QByteArray
+ * - 空闲时不占用池中存储：数据全部消费后存储归还给缓冲池，只有在组装半包
+ *   期间才一直持有；没有缓冲池时保留一块小缓冲区跨读取复用，避免每次读取
+ *   都分配、释放一次
+ *
+ * 使用方式：
+ * @code
+ * buffer.readFrom(socket);
+ * while (buffer.size() >= 4) {
+ *   const char *frame = buffer.data();
+ *   ...
+ *   buffer.consume(frameSize);
+ * }
+ * buffer.compact();
+ * @endcode
+ *
+ * 线程安全：
+ * - 此类不是线程安全的，只能在所属对象（和缓冲池）的线程中使用
+ */
+class ReceiveBuffer {
+public:
+  explicit ReceiveBuffer(SlabBufferPool *pool = nullptr);
+
+  ~ReceiveBuffer();
+
+  ReceiveBuffer(const ReceiveBuffer &) = delete;
+  ReceiveBuffer &operator=(const ReceiveBuffer &) = delete;
+
+  // 设置缓冲池（先归还当前存储，之后从新的缓冲池借出；nullptr 表示直接分配）
+  void setPool(SlabBufferPool *pool);
+
+  // 从设备读取所有可用数据，追加到缓冲区尾部，返回读取的字节数
+  qint64 readFrom(QIODevice *device);
+
+  // 追加数据到缓冲区尾部
+  void append(const char *data, qsizetype size);
+
+  // 未读数据的起始地址
+  const char *data() const { return m_data.constData() + m_readPos; }
+
+  // 未读数据的字节数
+  qsizetype size() const { return m_data.size() - m_readPos; }
+
+  bool isEmpty() const { return size() == 0; }
+
+  // 消费（跳过）已处理的字节，只移动读游标
+  void consume(qsizetype bytes) { m_readPos += bytes; }
+
+  // 为一个完整帧预留空间（半包时调用），避免后续频繁分配
+  void reserveFrame(qsizetype frameSize);
+
+  // 把未读数据移动到缓冲区头部，每次读取后调用一次；没有剩余数据时归还存储
+  // （没有缓冲池时保留小缓冲区）
+  void compact();
+
+  // 清空缓冲区并归还存储
+  void clear();
+
+  // 当前持有的存储容量（有缓冲池时空闲为 0）
+  qsizetype capacity() const { return m_data.capacity(); }
+
+private:
+  // 确保尾部至少有 bytes 字节的空闲空间
+  void ensureTailSpace(qsizetype bytes);
+
+  // 换成容量至少为 capacity 的存储，未读数据拷贝到头部
+  void replaceStorage(qsizetype capacity);
+
+  // 借出 / 归还存储
+  QByteArray acquireStorage(qsizetype capacity);
+  void releaseStorage();
+
+  QByteArray m_data;      // 底层存储（借自缓冲池）
+  qsizetype m_readPos;    // 读游标
+  SlabBufferPool *m_pool; // 缓冲池（可为空）
+};
+
+#endif // RECEIVEBUFFER_H
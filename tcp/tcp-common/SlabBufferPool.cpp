@@ -0,0 +1,94 @@
+#include "SlabBufferPool.h"
+
+void BufferPoolStats::add(const BufferPoolStats &other) {
+  leasedBuffers += other.leasedBuffers;
+  leasedBytes += other.leasedBytes;
+  cachedBuffers += other.cachedBuffers;
+  cachedBytes += other.cachedBytes;
+  acquires += other.acquires;
+  poolHits += other.poolHits;
+}
+
+SlabBufferPool::SlabBufferPool(qint64 maxCachedBytes)
+    : m_maxCachedBytes(qMax<qint64>(0, maxCachedBytes)) {}
+
+QByteArray SlabBufferPool::acquire(qsizetype minCapacity) {
+  m_acquires.fetch_add(1, std::memory_order_relaxed);
+
+  const int index = sizeClass(qMax(minCapacity, MIN_CLASS_SIZE));
+  QByteArray buffer;
+  if (index >= 0 && !m_free[index].isEmpty()) {
+    // 命中空闲缓冲区：内容已在归还时清空，容量不变
+    buffer = m_free[index].takeLast();
+    m_poolHits.fetch_add(1, std::memory_order_relaxed);
+    m_cachedBuffers.fetch_sub(1, std::memory_order_relaxed);
+    m_cachedBytes.fetch_sub(buffer.capacity(), std::memory_order_relaxed);
+  } else {
+    buffer.reserve(index >= 0 ? classSize(index) : minCapacity);
+  }
+
+  m_leasedBuffers.fetch_add(1, std::memory_order_relaxed);
+  m_leasedBytes.fetch_add(buffer.capacity(), std::memory_order_relaxed);
+  return buffer;
+}
+
+void SlabBufferPool::release(QByteArray &&buffer) {
+  const qsizetype capacity = buffer.capacity();
+  m_leasedBuffers.fetch_sub(1, std::memory_order_relaxed);
+  m_leasedBytes.fetch_sub(capacity, std::memory_order_relaxed);
+
+  // 按容量向下取整到尺寸级别；超大缓冲区直接释放
+  int index = CLASS_COUNT - 1;
+  while (index >= 0 && classSize(index) > capacity) {
+    --index;
+  }
+  if (index < 0 || capacity > classSize(CLASS_COUNT - 1) ||
+      !buffer.isDetached()) {
+    return;
+  }
+
+  buffer.resize(0);
+  m_free[index].append(std::move(buffer));
+  m_cachedBuffers.fetch_add(1, std::memory_order_relaxed);
+  m_cachedBytes.fetch_add(capacity, std::memory_order_relaxed);
+  trim();
+}
+
+void SlabBufferPool::setMaxCachedBytes(qint64 maxCachedBytes) {
+  m_maxCachedBytes = qMax<qint64>(0, maxCachedBytes);
+  trim();
+}
+
+BufferPoolStats SlabBufferPool::snapshot() const {
+  BufferPoolStats stats;
+  stats.leasedBuffers = m_leasedBuffers.load(std::memory_order_relaxed);
+  stats.leasedBytes = m_leasedBytes.load(std::memory_order_relaxed);
+  stats.cachedBuffers = m_cachedBuffers.load(std::memory_order_relaxed);
+  stats.cachedBytes = m_cachedBytes.load(std::memory_order_relaxed);
+  stats.acquires = m_acquires.load(std::memory_order_relaxed);
+  stats.poolHits = m_poolHits.load(std::memory_order_relaxed);
+  return stats;
+}
+
+int SlabBufferPool::sizeClass(qsizetype bytes) {
+  for (int index = 0; index < CLASS_COUNT; ++index) {
+    if (bytes <= classSize(index)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
+void SlabBufferPool::trim() {
+  for (int index = CLASS_COUNT - 1;
+       index >= 0 &&
+       m_cachedBytes.load(std::memory_order_relaxed) > m_maxCachedBytes;
+       --index) {
+    while (!m_free[index].isEmpty() &&
+           m_cachedBytes.load(std::memory_order_relaxed) > m_maxCachedBytes) {
+      const qsizetype capacity = m_free[index].takeLast().capacity();
+      m_cachedBuffers.fetch_sub(1, std::memory_order_relaxed);
+      m_cachedBytes.fetch_sub(capacity, std::memory_order_relaxed);
+    }
+  }
+}
@@ -0,0 +1,79 @@
+#ifndef SLABBUFFERPOOL_H
+#define SLABBUFFERPOOL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+// 缓冲池占用快照（普通值，可复制、可合并）
+struct BufferPoolStats {
+  qint64 leasedBuffers = 0; // 借出中的缓冲区数（正在组装半包的连接）
+  qint64 leasedBytes = 0;   // 借出中的缓冲区容量
+  qint64 cachedBuffers = 0; // 池中空闲的缓冲区数
+  qint64 cachedBytes = 0;   // 池中空闲的缓冲区容量
+  quint64 acquires = 0;     // 借出次数
+  quint64 poolHits = 0;     // 直接从池中取得的次数
+
+  // 累加另一个缓冲池的统计
+  void add(const BufferPoolStats &other);
+};
+
+Q_DECLARE_METATYPE(BufferPoolStats)
+
+/**
+ * @brief 按尺寸分级的接收缓冲区池（每个 I/O 线程一个）
+ *
+ * 设计目的：
+ * - 空闲连接不持有缓冲区：只有在组装半包或解析本次读取的数据时才借出，
+ *   数据全部消费后立即归还
+ * - 缓冲区按 4KB、16KB、64KB、256KB、1MB 五个尺寸分级复用，
+ *   超过 1MB 的帧直接分配，归还时释放
+ * - 池中空闲缓冲区的总容量有上限，超出部分直接释放
+ *
+ * 线程安全：
+ * - 借出和归还只能在所属线程中调用
+ * - 统计计数器是原子变量，snapshot() 可以在任意线程调用
+ */
+class SlabBufferPool {
+public:
+  static constexpr int CLASS_COUNT = 5;
+  static constexpr qsizetype MIN_CLASS_SIZE = 4 * 1024;
+
+  explicit SlabBufferPool(qint64 maxCachedBytes = 16 * 1024 * 1024);
+
+  // 借出一个容量至少为 minCapacity 的空缓冲区
+  QByteArray acquire(qsizetype minCapacity);
+
+  // 归还缓冲区（内容被丢弃，容量保留在池中或释放）
+  void release(QByteArray &&buffer);
+
+  // 设置池中空闲缓冲区的总容量上限，超出部分立即释放
+  void setMaxCachedBytes(qint64 maxCachedBytes);
+
+  // 占用快照（线程安全）
+  BufferPoolStats snapshot() const;
+
+  // 容纳 bytes 字节的最小尺寸级别，超过最大级别时返回 -1
+  static int sizeClass(qsizetype bytes);
+
+  // 尺寸级别对应的容量
+  static qsizetype classSize(int index) { return MIN_CLASS_SIZE << (2 * index); }
+
+private:
+  // 释放空闲缓冲区直到总容量不超过上限（先释放大的）
+  void trim();
+
+  std::array<QList<QByteArray>, CLASS_COUNT> m_free; // 每个级别的空闲缓冲区
+  qint64 m_maxCachedBytes;                           // 空闲容量上限
+  std::atomic<qint64> m_leasedBuffers{0};
+  std::atomic<qint64> m_leasedBytes{0};
+  std::atomic<qint64> m_cachedBuffers{0};
+  std::atomic<qint64> m_cachedBytes{0};
+  std::atomic<quint64> m_acquires{0};
+  std::atomic<quint64> m_poolHits{0};
+};
+
+#endif // SLABBUFFERPOOL_H
@@ -0,0 +1,61 @@
+#include "WriteCoalescer.h"
+
+bool WriteCoalescer::enqueue(const QByteArray &frame, bool droppable) {
+  m_frames.append(PendingFrame{frame, droppable});
+  m_pendingBytes += frame.size();
+  return m_pendingBytes >= m_options.flushThresholdBytes;
+}
+
+QByteArray WriteCoalescer::take(qint64 maxBytes) {
+  if (m_frames.isEmpty() || maxBytes <= 0) {
+    return {};
+  }
+
+  // 计算本次取出的帧数：至少一帧，总字节数不超过 maxBytes
+  qsizetype count = 1;
+  qint64 bytes = m_frames.first().data.size();
+  while (count < m_frames.size() &&
+         bytes + m_frames.at(count).data.size() <= maxBytes) {
+    bytes += m_frames.at(count).data.size();
+    ++count;
+  }
+
+  // 只有一帧时直接返回，避免拷贝
+  if (count == 1) {
+    QByteArray frame = m_frames.takeFirst().data;
+    m_pendingBytes -= frame.size();
+    return frame;
+  }
+
+  // QTcpSocket 没有 writev 接口：把所有帧拼接为一个连续缓冲区，
+  // 一次 write + flush 即可交给内核
+  QByteArray gathered;
+  gathered.reserve(static_cast<qsizetype>(bytes));
+  for (qsizetype i = 0; i < count; ++i) {
+    gathered.append(m_frames.at(i).data);
+  }
+
+  if (count == m_frames.size()) {
+    clear();
+  } else {
+    m_frames.remove(0, count);
+    m_pendingBytes -= bytes;
+  }
+  return gathered;
+}
+
+qint64 WriteCoalescer::dropOldest() {
+  for (qsizetype i = 0; i < m_frames.size(); ++i) {
+    if (m_frames.at(i).droppable) {
+      const qint64 bytes = m_frames.takeAt(i).data.size();
+      m_pendingBytes -= bytes;
+      return bytes;
+    }
+  }
+  return 0;
+}
+
+void WriteCoalescer::clear() {
+  m_frames.clear();
+  m_pendingBytes = 0;
+}
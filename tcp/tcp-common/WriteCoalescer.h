@@ -0,0 +1,78 @@
+#ifndef WRITECOALESCER_H
+#define WRITECOALESCER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+#include <limits>
+
+// 写合并（corking）配置
+struct WriteCoalescingOptions {
+  bool enabled = false;                   // 是否启用写合并
+  int flushDelayMs = 0;                   // 最长等待时间，0 表示本次事件循环迭代结束时写出
+  qint64 flushThresholdBytes = 64 * 1024; // 累计字节数达到阈值时立即写出
+};
+
+Q_DECLARE_METATYPE(WriteCoalescingOptions)
+
+/**
+ * @brief 待写帧收集器（写合并）
+ *
+ * 功能特性：
+ * - 收集一次事件循环迭代内排队的所有出站帧
+ * - 写出时把所有帧合并为一个连续缓冲区，一次 write + flush 完成发送
+ * - 只有一帧时直接返回该帧（隐式共享，无拷贝）
+ *
+ * 何时写出由持有者决定（定时器或字节阈值），此类只负责收集和合并。
+ * 启用发送队列水位控制时，它同时作为尚未交给 socket 的出站队列，
+ * 支持按字节预算分批取出和丢弃最旧的帧（入队时标记为不可丢弃的帧除外，
+ * 例如分块消息的各块，丢弃其中一块会破坏整条消息）。
+ *
+ * 线程安全：
+ * - 此类不是线程安全的，只能在所属对象的线程中使用
+ */
+class WriteCoalescer {
+public:
+  WriteCoalescer() = default;
+
+  // 设置配置
+  void setOptions(const WriteCoalescingOptions &options) {
+    m_options = options;
+  }
+
+  const WriteCoalescingOptions &options() const { return m_options; }
+
+  bool isEnabled() const { return m_options.enabled; }
+
+  // 追加一帧，返回 true 表示已达到字节阈值，应立即写出
+  bool enqueue(const QByteArray &frame, bool droppable = true);
+
+  // 待写字节数
+  qint64 pendingBytes() const { return m_pendingBytes; }
+
+  bool isEmpty() const { return m_frames.isEmpty(); }
+
+  // 取出所有待写帧并合并为一个连续缓冲区
+  QByteArray takeAll() { return take(std::numeric_limits<qint64>::max()); }
+
+  // 从队首取出总字节数不超过 maxBytes 的帧（至少一帧）并合并
+  QByteArray take(qint64 maxBytes);
+
+  // 丢弃最旧的一个可丢弃帧，返回释放的字节数，没有可丢弃的帧时返回 0
+  qint64 dropOldest();
+
+  // 丢弃所有待写帧
+  void clear();
+
+private:
+  struct PendingFrame {
+    QByteArray data;       // 帧数据（隐式共享，广播帧不拷贝）
+    bool droppable = true; // 超过水位时能否丢弃
+  };
+
+  WriteCoalescingOptions m_options;
+  QList<PendingFrame> m_frames; // 待写帧
+  qint64 m_pendingBytes = 0;    // 待写字节数
+};
+
+#endif // WRITECOALESCER_H
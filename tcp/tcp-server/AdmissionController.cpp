@@ -0,0 +1,174 @@
+#include "AdmissionController.h"
+#include <QMutexLocker>
+#include <QTcpSocket>
+
+#if defined(Q_OS_UNIX)
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#endif
+
+namespace {
+#if defined(Q_OS_WIN)
+using NativeSocket = SOCKET;
+#else
+using NativeSocket = int;
+#endif
+
+// IPv4 地址的键与 IPv4 映射地址（::ffff:a.b.c.d）的低 64 位一致
+constexpr quint64 IPV4_KEY_PREFIX = quint64(0xFFFF) << 32;
+
+// 令牌桶容量
+double bucketSize(const AdmissionOptions &options) {
+  return options.acceptBurst > 0 ? options.acceptBurst
+                                 : qMax(1.0, options.acceptRate);
+}
+} // namespace
+
+AdmissionController::AdmissionController() { m_clock.start(); }
+
+void AdmissionController::setOptions(const AdmissionOptions &options) {
+  QMutexLocker locker(&m_mutex);
+  m_options = options;
+  m_options.maxConnections = qMax(0, m_options.maxConnections);
+  m_options.maxPerIp = qMax(0, m_options.maxPerIp);
+  m_options.acceptRate = qMax(0.0, m_options.acceptRate);
+  m_options.acceptBurst = qMax(0, m_options.acceptBurst);
+  m_trackAddresses.store(m_options.maxPerIp > 0, std::memory_order_relaxed);
+  m_tokens = bucketSize(m_options);
+  m_lastRefillNs = m_clock.nsecsElapsed();
+}
+
+AdmissionOptions AdmissionController::options() const {
+  QMutexLocker locker(&m_mutex);
+  return m_options;
+}
+
+bool AdmissionController::tryAdmit(qintptr socketDescriptor, quint64 *key) {
+  *key = NO_KEY;
+
+  // 单地址上限需要对端地址，在锁外获取（一次系统调用）
+  const quint64 address = m_trackAddresses.load(std::memory_order_relaxed)
+                             ? peerKey(socketDescriptor)
+                             : NO_KEY;
+
+  QMutexLocker locker(&m_mutex);
+  if (m_options.acceptRate > 0) {
+    refillTokens();
+    if (m_tokens < 1.0) {
+      m_rejectedRate.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+  }
+  if (m_options.maxConnections > 0 &&
+      m_connections >= m_options.maxConnections) {
+    m_rejectedGlobal.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (m_options.maxPerIp > 0 && address != NO_KEY) {
+    int &count = m_perAddress[address];
+    if (count >= m_options.maxPerIp) {
+      m_rejectedPerIp.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    ++count;
+    *key = address;
+  }
+
+  if (m_options.acceptRate > 0) {
+    m_tokens -= 1.0;
+  }
+  ++m_connections;
+  m_admitted.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+void AdmissionController::release(quint64 key) {
+  QMutexLocker locker(&m_mutex);
+  if (m_connections > 0) {
+    --m_connections;
+  }
+  if (key == NO_KEY) {
+    return;
+  }
+  auto it = m_perAddress.find(key);
+  if (it != m_perAddress.end() && --it.value() <= 0) {
+    m_perAddress.erase(it);
+  }
+}
+
+void AdmissionController::reset() {
+  QMutexLocker locker(&m_mutex);
+  m_perAddress.clear();
+  m_connections = 0;
+}
+
+AdmissionStats AdmissionController::snapshot() const {
+  AdmissionStats stats;
+  {
+    QMutexLocker locker(&m_mutex);
+    stats.connections = m_connections;
+    stats.trackedAddresses = static_cast<int>(m_perAddress.size());
+  }
+  stats.admitted = m_admitted.load(std::memory_order_relaxed);
+  stats.rejectedGlobal = m_rejectedGlobal.load(std::memory_order_relaxed);
+  stats.rejectedPerIp = m_rejectedPerIp.load(std::memory_order_relaxed);
+  stats.rejectedRate = m_rejectedRate.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void AdmissionController::refillTokens() {
+  const qint64 nowNs = m_clock.nsecsElapsed();
+  const double elapsedSec = (nowNs - m_lastRefillNs) / 1e9;
+  m_lastRefillNs = nowNs;
+  m_tokens = qMin(bucketSize(m_options),
+                  m_tokens + elapsedSec * m_options.acceptRate);
+}
+
+void AdmissionController::closeDescriptor(qintptr socketDescriptor) {
+#if defined(Q_OS_UNIX)
+  ::close(static_cast<NativeSocket>(socketDescriptor));
+#elif defined(Q_OS_WIN)
+  ::closesocket(static_cast<NativeSocket>(socketDescriptor));
+#else
+  QTcpSocket socket;
+  if (socket.setSocketDescriptor(socketDescriptor)) {
+    socket.abort();
+  }
+#endif
+}
+
+quint64 AdmissionController::peerKey(qintptr socketDescriptor) {
+#if defined(Q_OS_UNIX) || defined(Q_OS_WIN)
+  sockaddr_storage storage;
+  socklen_t length = sizeof(storage);
+  if (::getpeername(static_cast<NativeSocket>(socketDescriptor),
+                    reinterpret_cast<sockaddr *>(&storage), &length) != 0) {
+    return NO_KEY;
+  }
+
+  if (storage.ss_family == AF_INET) {
+    const auto *v4 = reinterpret_cast<const sockaddr_in *>(&storage);
+    return IPV4_KEY_PREFIX | ntohl(v4->sin_addr.s_addr);
+  }
+  if (storage.ss_family == AF_INET6) {
+    const auto *v6 = reinterpret_cast<const sockaddr_in6 *>(&storage);
+    const unsigned char *bytes = v6->sin6_addr.s6_addr;
+    quint64 high = 0;
+    quint64 low = 0;
+    for (int i = 0; i < 8; ++i) {
+      high = (high << 8) | bytes[i];
+      low = (low << 8) | bytes[i + 8];
+    }
+    // IPv4 映射地址按 IPv4 计数，其余按 /64 前缀
+    return high == 0 && (low >> 32) == 0xFFFF ? low : high;
+  }
+  return NO_KEY;
+#else
+  Q_UNUSED(socketDescriptor)
+  return NO_KEY;
+#endif
+}
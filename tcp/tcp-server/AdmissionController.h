@@ -0,0 +1,98 @@
+#ifndef ADMISSIONCONTROLLER_H
+#define ADMISSIONCONTROLLER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMetaType>
+#include <QMutex>
+#include <QtGlobal>
+#include <atomic>
+
+// 连接准入配置（所有限制默认关闭，0 表示不限制）
+// 单地址上限中 IPv6 地址按 /64 前缀合并；令牌桶容量为 0 时取 max(1, acceptRate)
+struct AdmissionOptions {
+  int maxConnections = 0; // 全局连接数上限
+  int maxPerIp = 0;       // 每个来源地址的连接数上限
+  double acceptRate = 0;  // 令牌桶速率（每秒接受的连接数）
+  int acceptBurst = 0;    // 令牌桶容量（允许的突发连接数）
+};
+
+// 连接准入统计快照
+struct AdmissionStats {
+  int connections = 0;        // 当前已准入的连接数
+  int trackedAddresses = 0;   // 地址表中的来源地址数
+  quint64 admitted = 0;       // 准入的连接数
+  quint64 rejectedGlobal = 0; // 因全局上限拒绝的连接数
+  quint64 rejectedPerIp = 0;  // 因单地址上限拒绝的连接数
+  quint64 rejectedRate = 0;   // 因接受速率超限拒绝的连接数
+
+  // 拒绝的连接总数
+  quint64 rejected() const {
+    return rejectedGlobal + rejectedPerIp + rejectedRate;
+  }
+};
+
+/**
+ * @brief 连接准入控制（全局上限、单地址上限、接受速率令牌桶）
+ *
+ * 功能特性：
+ * - 每个新描述符在创建 QTcpSocket 之前检查，被拒绝的描述符直接关闭
+ * - 来源地址压缩为 64 位键：IPv4（含 IPv4 映射地址）为地址本身，
+ *   IPv6 取 /64 前缀，同一网段的地址共享一个计数
+ * - 地址表只保存有连接的地址，计数归零时删除
+ * - 检查只有一次 getpeername（仅启用单地址上限时）和一次短临界区的 O(1) 操作
+ *
+ * 线程安全：
+ * - 所有方法都是线程安全的：主线程 accept 和各 Worker 的 SO_REUSEPORT
+ *   监听同时调用 tryAdmit，Worker 在连接断开时调用 release
+ */
+class AdmissionController {
+public:
+  static constexpr quint64 NO_KEY = 0; // 未按地址计数的连接
+
+  AdmissionController();
+
+  // 设置准入配置（对之后的连接生效，令牌桶重新装满）
+  void setOptions(const AdmissionOptions &options);
+
+  AdmissionOptions options() const;
+
+  // 检查是否接受描述符，接受时返回 true 并给出地址键（release 时传回）
+  bool tryAdmit(qintptr socketDescriptor, quint64 *key);
+
+  // 连接关闭（或准入后未能建立），归还计数
+  void release(quint64 key);
+
+  // 清空连接计数和地址表（线程池停止时调用，统计保留）
+  void reset();
+
+  // 生成统计快照
+  AdmissionStats snapshot() const;
+
+  // 关闭被拒绝的描述符
+  static void closeDescriptor(qintptr socketDescriptor);
+
+  // 描述符对端地址的键，无法获取时返回 NO_KEY
+  static quint64 peerKey(qintptr socketDescriptor);
+
+private:
+  // 按经过的时间补充令牌（调用方持有锁）
+  void refillTokens();
+
+  mutable QMutex m_mutex;
+  AdmissionOptions m_options;        // 准入配置
+  QHash<quint64, int> m_perAddress;  // 地址键 → 连接数
+  int m_connections = 0;             // 已准入的连接数
+  double m_tokens = 0;               // 令牌桶中的令牌
+  qint64 m_lastRefillNs = 0;         // 上次补充令牌的时间
+  QElapsedTimer m_clock;             // 令牌桶时钟
+  std::atomic<bool> m_trackAddresses{false}; // 是否启用单地址上限（锁外读取）
+  std::atomic<quint64> m_admitted{0};
+  std::atomic<quint64> m_rejectedGlobal{0};
+  std::atomic<quint64> m_rejectedPerIp{0};
+  std::atomic<quint64> m_rejectedRate{0};
+};
+
+Q_DECLARE_METATYPE(AdmissionOptions)
+
+#endif // ADMISSIONCONTROLLER_H
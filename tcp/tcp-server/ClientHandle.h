@@ -0,0 +1,65 @@
+#ifndef CLIENTHANDLE_H
+#define CLIENTHANDLE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief 客户端句柄
+ *
+ * 不透明的 64 位客户端标识，替代 socket 描述符：
+ * - 内核会很快复用已关闭的描述符，迟到的发送或断开通知可能命中新的客户端
+ * - 句柄编码了 Worker 索引、槽位索引和代数，路由时无需查表
+ * - 槽位每次释放都会递增代数，过期句柄在 Worker 中以一次比较被拒绝
+ *
+ * 位布局（共 52 位，可无损表示为 JavaScript 数值）：
+ * [Worker 索引 8 位][槽位索引 20 位][代数 24 位]
+ *
+ * 代数从 1 开始，因此有效句柄永不为 0。
+ */
+using ClientId = quint64;
+
+namespace ClientHandle {
+
+constexpr int WORKER_BITS = 8;
+constexpr int SLOT_BITS = 20;
+constexpr int GENERATION_BITS = 24;
+
+constexpr int MAX_WORKERS = 1 << WORKER_BITS;           // 最多 256 个 Worker
+constexpr quint32 MAX_SLOTS = 1u << SLOT_BITS;          // 每个 Worker 的槽位上限
+constexpr quint32 GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+
+// 无效句柄
+constexpr ClientId Invalid = 0;
+
+// 组合句柄
+constexpr ClientId make(int workerIndex, quint32 slot, quint32 generation) {
+  return (static_cast<ClientId>(workerIndex) << (SLOT_BITS + GENERATION_BITS)) |
+         (static_cast<ClientId>(slot) << GENERATION_BITS) |
+         static_cast<ClientId>(generation & GENERATION_MASK);
+}
+
+// 取出 Worker 索引
+constexpr int workerIndex(ClientId id) {
+  return static_cast<int>((id >> (SLOT_BITS + GENERATION_BITS)) &
+                          (MAX_WORKERS - 1));
+}
+
+// 取出槽位索引
+constexpr quint32 slotIndex(ClientId id) {
+  return static_cast<quint32>((id >> GENERATION_BITS) & (MAX_SLOTS - 1));
+}
+
+// 取出代数
+constexpr quint32 generation(ClientId id) {
+  return static_cast<quint32>(id & GENERATION_MASK);
+}
+
+// 下一个代数（跳过 0，保证句柄非 0）
+constexpr quint32 nextGeneration(quint32 generation) {
+  const quint32 next = (generation + 1) & GENERATION_MASK;
+  return next == 0 ? 1 : next;
+}
+
+} // namespace ClientHandle
+
+#endif // CLIENTHANDLE_H
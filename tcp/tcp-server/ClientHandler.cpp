@@ -1,13 +1,18 @@
 #include "ClientHandler.h"
-#include <QDataStream>
 #include <QDebug>
 #include <QHostAddress>
 #include <QThread>
+#include <limits>
 
-ClientHandler::ClientHandler(qintptr socketDescriptor, QObject *parent)
-    : QObject(parent), m_socketDescriptor(socketDescriptor), m_socket(nullptr) {
-  // 预分配接收缓冲区
-  m_receiveBuffer.reserve(4096);
+ClientHandler::ClientHandler(QObject *parent)
+    : QObject(parent), m_socket(new QTcpSocket(this)) {
+  // 信号只连接一次，处理器回收后继续使用同一个 socket
+  connect(m_socket, &QTcpSocket::readyRead, this, &ClientHandler::onReadyRead);
+  connect(m_socket, &QTcpSocket::disconnected, this,
+          &ClientHandler::onDisconnected);
+  connect(m_socket, &QTcpSocket::errorOccurred, this, &ClientHandler::onError);
+  connect(m_socket, &QTcpSocket::bytesWritten, this,
+          &ClientHandler::onBytesWritten);
 }
 
 ClientHandler::~ClientHandler() {
@@ -15,28 +20,41 @@ ClientHandler::~ClientHandler() {
     m_socket->disconnectFromHost();
     m_socket->deleteLater();
   }
-  qDebug() << "[ClientHandler]" << m_socketDescriptor << "析构";
 }
 
-void ClientHandler::initialize() {
-  // 在目标线程中创建 QTcpSocket
-  m_socket = new QTcpSocket(this);
+void ClientHandler::resetConnectionState() {
+  // 缓冲区只清空内容，保留已分配的容量
+  m_receiveBuffer.clear();
+  m_writeCoalescer.clear();
+  m_droppedMessages = 0;
+  m_sendQueueHigh = false;
+  m_aborting = false;
+  m_clientAddress.clear();
+  m_reportedPending = 0;
+  m_reportedRtt = 0;
+  m_rtt.reset();
+  m_unansweredPings = 0;
+  m_lastActivityTick = 0;
+  m_protocolVersion = FrameCodec::VERSION_1;
+  m_peerFeatures = 0;
+  m_chunks.clear();
+}
 
-  // 使用 socket 描述符设置连接
+void ClientHandler::initialize(ClientId clientId, qintptr socketDescriptor) {
+  resetConnectionState();
+  m_clientId = clientId;
+  m_socketDescriptor = socketDescriptor;
+
+  // 使用 socket 描述符设置连接（对已断开的 socket 同样有效）
   if (!m_socket->setSocketDescriptor(m_socketDescriptor)) {
-    qWarning() << "[ClientHandler] 设置 socket 描述符失败:"
-               << m_socketDescriptor;
-    emit errorOccurred(m_socketDescriptor, "设置 socket 描述符失败");
-    deleteLater();
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                         << "设置 socket 描述符失败:" << m_socketDescriptor;
+    emit errorOccurred(m_clientId, "设置 socket 描述符失败");
+    // 通知 Worker 释放槽位、归还连接计数并回收本对象
+    emit disconnected(m_clientId);
     return;
   }
 
-  // 连接信号
-  connect(m_socket, &QTcpSocket::readyRead, this, &ClientHandler::onReadyRead);
-  connect(m_socket, &QTcpSocket::disconnected, this,
-          &ClientHandler::onDisconnected);
-  connect(m_socket, &QTcpSocket::errorOccurred, this, &ClientHandler::onError);
-
   // 获取并缓存客户端地址
   QHostAddress peerAddr = m_socket->peerAddress();
   QString clientAddressStr;
@@ -57,141 +75,619 @@ void ClientHandler::initialize() {
   m_clientAddress =
       QString("%1:%2").arg(clientAddressStr).arg(m_socket->peerPort());
 
-  qDebug() << "[ClientHandler]" << m_socketDescriptor
-           << "初始化完成，地址:" << m_clientAddress
-           << "线程:" << QThread::currentThread();
+  NET_DEBUG(lcNetIo) << "[ClientHandler]" << m_clientId
+                     << "初始化完成，地址:" << m_clientAddress
+                     << "线程:" << QThread::currentThread();
+
+  // 建立连接也算一次活动
+  touch();
 
   // 发出就绪信号
-  emit ready(m_socketDescriptor, m_clientAddress);
+  emit ready(m_clientId, m_clientAddress);
 }
 
 void ClientHandler::sendMessage(const QString &message) {
+  sendData(message.toUtf8());
+}
+
+void ClientHandler::sendData(const QByteArray &data) {
+  sendPacket(encodeData(data));
+}
+
+void ClientHandler::sendFrame(const FrameCodec::PreparedFrame &frame) {
+  const bool accepts = peerAcceptsCompression();
+  if (frame.usesCompression(m_protocolVersion, accepts)) {
+    recordCompressed(frame.payload().size(), frame.compressed().size());
+  }
+  sendPacket(frame.packet(m_protocolVersion, accepts));
+}
+
+QByteArray ClientHandler::encodeData(const QByteArray &data) {
+  if (peerAcceptsCompression()) {
+    const QByteArray compressed =
+        FrameCompression::compress(data, m_compression);
+    if (!compressed.isEmpty()) {
+      recordCompressed(data.size(), compressed.size());
+      return FrameCodec::packFrame(
+          m_protocolVersion, FrameCodec::MessageType::Data,
+          FrameCodec::FLAG_COMPRESSED, compressed.constData(),
+          compressed.size());
+    }
+  }
+  return packMessage(data, m_protocolVersion);
+}
+
+void ClientHandler::recordCompressed(qsizetype originalSize,
+                                     qsizetype compressedSize) {
+  if (m_counters) {
+    m_counters->compressedOut.fetch_add(1, std::memory_order_relaxed);
+    m_counters->compressionSavedBytes.fetch_add(
+        static_cast<quint64>(originalSize - compressedSize),
+        std::memory_order_relaxed);
+  }
+}
+
+void ClientHandler::sendPacket(const QByteArray &packet) {
+  enqueuePacket(packet, true);
+}
+
+void ClientHandler::sendChunk(quint32 streamId, const QByteArray &data,
+                              bool last) {
+  if (!peerAcceptsChunks()) {
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                         << "对端不支持分块消息，丢弃";
+    emit errorOccurred(m_clientId, "对端不支持分块消息");
+    return;
+  }
+
+  // 超过单块上限时拆分，只有最后一块带结束标志
+  qsizetype offset = 0;
+  do {
+    const qsizetype size =
+        qMin<qsizetype>(data.size() - offset, FrameCodec::MAX_CHUNK_SIZE);
+    const bool isLast = last && offset + size == data.size();
+    enqueuePacket(FrameCodec::packChunk(streamId, data.constData() + offset,
+                                        size, isLast),
+                  false);
+    offset += size;
+  } while (offset < data.size());
+}
+
+void ClientHandler::sendGoodbye() {
+  if (m_protocolVersion < FrameCodec::VERSION_2) {
+    return;
+  }
+  enqueuePacket(FrameCodec::packGoodbye(m_protocolVersion), false);
+}
+
+void ClientHandler::enqueuePacket(const QByteArray &packet, bool droppable) {
+  if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState ||
+      m_aborting) {
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                         << "socket 未连接，无法发送消息";
+    return;
+  }
+
+  // 发送队列水位控制（广播同样经过这里）
+  if (hasSendQueueLimits() && !admitPacket(packet.size(), droppable)) {
+    return;
+  }
+  if (m_counters) {
+    m_counters->messagesOut.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // 未启用写合并和水位控制：直接写入
+  if (!m_writeCoalescer.isEnabled() && !hasSendQueueLimits()) {
+    qint64 written = m_socket->write(packet);
+    m_socket->flush();
+
+    if (written != packet.size()) {
+      NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                           << "发送消息不完整";
+      emit errorOccurred(m_clientId, "发送消息不完整");
+    } else {
+      NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+          << "[ClientHandler]" << m_clientId
+          << "发送数据包 (字节数:" << packet.size() << ")";
+    }
+    updatePendingGauge();
+    return;
+  }
+
+  // 先进入出站队列；写合并模式由 Worker 在本次事件循环迭代结束时统一写出
+  const bool wasEmpty = m_writeCoalescer.isEmpty();
+  const bool thresholdReached = m_writeCoalescer.enqueue(packet, droppable);
+  if (!m_writeCoalescer.isEnabled() || thresholdReached) {
+    flushPendingWrites();
+  } else if (wasEmpty) {
+    emit writePending(m_clientId);
+  }
+  updatePendingGauge();
+}
+
+void ClientHandler::flushPendingWrites() {
+  if (m_writeCoalescer.isEmpty()) {
+    return;
+  }
+
   if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState) {
-    qWarning() << "[ClientHandler]" << m_socketDescriptor
-               << "socket 未连接，无法发送消息";
+    m_writeCoalescer.clear();
     return;
   }
 
-  QByteArray packet = packMessage(message);
-  qint64 written = m_socket->write(packet);
+  // 启用水位控制时，socket 内部缓冲最多保留到低水位，其余留在出站队列中
+  // （在那里才能按策略丢弃），bytesWritten 后继续写出
+  qint64 budget = std::numeric_limits<qint64>::max();
+  if (hasSendQueueLimits()) {
+    budget = m_sendLimits.lowWaterMark - m_socket->bytesToWrite();
+    if (budget <= 0) {
+      return;
+    }
+  }
+
+  // 缓存帧合并为一个缓冲区，一次写入
+  const QByteArray data = m_writeCoalescer.take(budget);
+  qint64 written = m_socket->write(data);
   m_socket->flush();
 
-  if (written != packet.size()) {
-    qWarning() << "[ClientHandler]" << m_socketDescriptor << "发送消息不完整";
-    emit errorOccurred(m_socketDescriptor, "发送消息不完整");
+  if (written != data.size()) {
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId << "发送消息不完整";
+    emit errorOccurred(m_clientId, "发送消息不完整");
   } else {
-    qDebug() << "[ClientHandler]" << m_socketDescriptor
-             << "发送消息:" << message << "(字节数:" << packet.size() << ")";
+    NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+        << "[ClientHandler]" << m_clientId
+        << "合并写出 (字节数:" << data.size() << ")";
+  }
+  updatePendingGauge();
+}
+
+void ClientHandler::setWriteCoalescing(const WriteCoalescingOptions &options) {
+  if (!options.enabled) {
+    flushPendingWrites();
+  }
+  m_writeCoalescer.setOptions(options);
+}
+
+void ClientHandler::setSendQueueLimits(const SendQueueLimits &limits) {
+  m_sendLimits = limits;
+  m_sendLimits.highWaterMark = qMax<qint64>(0, m_sendLimits.highWaterMark);
+
+  // 低水位未设置或不合法时取高水位的一半
+  if (m_sendLimits.lowWaterMark <= 0 ||
+      m_sendLimits.lowWaterMark > m_sendLimits.highWaterMark) {
+    m_sendLimits.lowWaterMark = m_sendLimits.highWaterMark / 2;
+  }
+
+  // 关闭水位控制时写出所有排队数据
+  if (!hasSendQueueLimits()) {
+    m_sendQueueHigh = false;
+    if (!m_writeCoalescer.isEnabled()) {
+      flushPendingWrites();
+    }
+  }
+}
+
+qint64 ClientHandler::pendingSendBytes() const {
+  const qint64 socketBytes = m_socket ? m_socket->bytesToWrite() : 0;
+  return socketBytes + m_writeCoalescer.pendingBytes();
+}
+
+bool ClientHandler::admitPacket(qint64 packetSize, bool droppable) {
+  const qint64 pending = pendingSendBytes();
+  if (pending + packetSize <= m_sendLimits.highWaterMark) {
+    return true;
+  }
+
+  // 进入高水位状态时通知一次
+  if (!m_sendQueueHigh) {
+    m_sendQueueHigh = true;
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                         << "发送队列超过高水位:" << pending;
+    emit sendQueueHigh(m_clientId, pending);
+  }
+
+  // 分块消息的各块不能丢弃（会破坏整条消息），超过水位后照常排队
+  if (!droppable && m_sendLimits.policy != OverflowPolicy::Disconnect) {
+    return true;
+  }
+
+  switch (m_sendLimits.policy) {
+  case OverflowPolicy::DropOldest: {
+    // 只能丢弃尚未交给 socket 的排队帧
+    qint64 excess = pending + packetSize - m_sendLimits.highWaterMark;
+    while (excess > 0) {
+      const qint64 freed = m_writeCoalescer.dropOldest();
+      if (freed == 0) {
+        break;
+      }
+      excess -= freed;
+      recordDroppedMessage();
+    }
+    if (excess <= 0) {
+      return true;
+    }
+    // 排队帧不足以腾出空间（数据都在 socket 中），退化为丢弃新消息
+    recordDroppedMessage();
+    return false;
+  }
+  case OverflowPolicy::Disconnect:
+    abortSlowConsumer();
+    return false;
+  case OverflowPolicy::DropNewest:
+  default:
+    recordDroppedMessage();
+    return false;
+  }
+}
+
+void ClientHandler::abortSlowConsumer() {
+  if (m_aborting) {
+    return;
+  }
+  m_aborting = true;
+  m_writeCoalescer.clear();
+
+  NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                       << "发送队列超限，断开慢速客户端";
+  emit errorOccurred(m_clientId, "发送队列超限，断开慢速客户端");
+
+  // 处理器可能在执行前被回收并接管新连接，只中止原来的连接
+  QMetaObject::invokeMethod(
+      this,
+      [this, clientId = m_clientId]() {
+        if (m_socket && m_clientId == clientId) {
+          m_socket->abort();
+        }
+      },
+      Qt::QueuedConnection);
+}
+
+void ClientHandler::recordDroppedMessage() {
+  ++m_droppedMessages;
+  if (m_counters) {
+    m_counters->droppedMessages.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ClientHandler::updatePendingGauge() {
+  if (!m_counters) {
+    return;
+  }
+
+  // 只提交差值，Worker 计数器即为本线程所有连接待发送字节数之和
+  const qint64 pending = pendingSendBytes();
+  if (pending != m_reportedPending) {
+    m_counters->pendingSendBytes.fetch_add(pending - m_reportedPending,
+                                           std::memory_order_relaxed);
+    m_reportedPending = pending;
   }
 }
 
 void ClientHandler::disconnect() {
+  // 先把出站队列全部交给 socket，避免丢失已排队的数据。这里不受低水位预算
+  // 限制：disconnectFromHost 之后 socket 不再是连接状态，留在队列中的帧
+  // 会在下一次 flushPendingWrites 时被清除
+  if (m_socket && m_socket->state() == QAbstractSocket::ConnectedState &&
+      !m_writeCoalescer.isEmpty()) {
+    const QByteArray data = m_writeCoalescer.takeAll();
+    if (m_socket->write(data) != data.size()) {
+      NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                           << "发送消息不完整";
+      emit errorOccurred(m_clientId, "发送消息不完整");
+    }
+    updatePendingGauge();
+  }
+
   if (m_socket && m_socket->state() != QAbstractSocket::UnconnectedState) {
     m_socket->disconnectFromHost();
   }
 }
 
-QByteArray ClientHandler::packMessage(const QString &message) {
-  // 消息格式：[4字节长度(网络字节序/大端)][消息内容UTF-8]
-  QByteArray utf8Data = message.toUtf8();
-  quint32 messageLength = static_cast<quint32>(utf8Data.size());
-
-  // 预分配内存
-  QByteArray packet;
-  packet.reserve(sizeof(quint32) + messageLength);
-
-  QDataStream stream(&packet, QIODevice::WriteOnly);
-  stream.setByteOrder(QDataStream::BigEndian);
+void ClientHandler::abort() {
+  m_writeCoalescer.clear();
+  if (m_socket) {
+    m_socket->abort();
+  }
+}
 
-  stream << messageLength;
-  packet.append(utf8Data);
+QByteArray ClientHandler::packMessage(const QByteArray &data, int version) {
+  return FrameCodec::packData(data, version);
+}
 
-  return packet;
+QByteArray ClientHandler::packMessage(const QString &message, int version) {
+  return packMessage(message.toUtf8(), version);
 }
 
 void ClientHandler::parseReceivedData() {
-  // 读取所有可用数据到缓冲区
-  m_receiveBuffer.append(m_socket->readAll());
-
-  // 循环解析完整的消息
-  while (m_receiveBuffer.size() >= static_cast<int>(sizeof(quint32))) {
-    // 读取消息长度（前4字节，大端）
-    QDataStream stream(m_receiveBuffer);
-    stream.setByteOrder(QDataStream::BigEndian);
-
-    quint32 messageLength;
-    stream >> messageLength;
-
-    // 检查消息长度合法性
-    constexpr quint32 MAX_MESSAGE_SIZE = 10 * 1024 * 1024; // 10MB上限
-    if (messageLength > MAX_MESSAGE_SIZE) {
-      qWarning() << "[ClientHandler]" << m_socketDescriptor
-                 << "收到的消息过大:" << messageLength;
-      emit errorOccurred(m_socketDescriptor, "消息过大，断开连接");
-      m_socket->disconnectFromHost();
+  // 本次读取的时间点，用于统计读取到投递的耗时（每次读取只取一次时钟）
+  const qint64 readNs = m_counters ? LatencyHistogram::nowNs() : 0;
+
+  // 直接读入接收缓冲区尾部
+  const qint64 bytesRead = m_receiveBuffer.readFrom(m_socket);
+  if (bytesRead > 0) {
+    // 对端有任何数据到达都说明仍然存活
+    touch();
+    m_unansweredPings = 0;
+    if (m_counters) {
+      m_counters->bytesIn.fetch_add(static_cast<quint64>(bytesRead),
+                                    std::memory_order_relaxed);
+    }
+  }
+
+  // 循环解析完整的消息，只移动读游标
+  while (!m_receiveBuffer.isEmpty()) {
+    // 直接在缓冲区上解码帧头，第一个字节区分 v1 和 v2
+    const char *frame = m_receiveBuffer.data();
+    FrameCodec::FrameHeader header;
+    const FrameCodec::DecodeStatus status =
+        FrameCodec::decodeHeader(frame, m_receiveBuffer.size(), &header);
+    if (status == FrameCodec::DecodeStatus::NeedMore) {
+      break;
+    }
+
+    // 帧头非法或消息过大（控制帧只允许很短的内容）
+    if (status == FrameCodec::DecodeStatus::Invalid) {
+      abortOnProtocolError("消息过大，断开连接");
       return;
     }
 
     // 检查是否接收到完整消息（处理半包）
-    int totalSize = static_cast<int>(sizeof(quint32) + messageLength);
+    const qsizetype totalSize = header.frameSize();
     if (m_receiveBuffer.size() < totalSize) {
       // 数据不完整，等待更多数据
-      qDebug() << "[ClientHandler]" << m_socketDescriptor
-               << "数据不完整，等待..."
-               << "已接收:" << m_receiveBuffer.size() << "需要:" << totalSize;
+      NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+          << "[ClientHandler]" << m_clientId << "数据不完整，等待..."
+          << "已接收:" << m_receiveBuffer.size() << "需要:" << totalSize;
 
       // 预留足够空间，避免后续频繁分配
-      if (m_receiveBuffer.capacity() < totalSize) {
-        m_receiveBuffer.reserve(totalSize + 1024);
-      }
+      m_receiveBuffer.reserveFrame(totalSize);
       break;
     }
 
-    // 提取消息内容（跳过前4字节的长度字段）
-    QString message = QString::fromUtf8(
-        m_receiveBuffer.constData() + sizeof(quint32), messageLength);
+    // 分块帧：先移动读游标再处理（内容在下一次 compact 之前一直有效）
+    const char *payload = frame + header.headerSize;
+    if (header.type == FrameCodec::MessageType::Chunk) {
+      m_receiveBuffer.consume(totalSize);
+      if (!handleChunkFrame(header, payload, readNs)) {
+        return;
+      }
+      continue;
+    }
 
-    // 从缓冲区移除已处理的消息（处理黏包）
-    m_receiveBuffer.remove(0, totalSize);
+    // 控制帧在本线程内处理，不向上投递
+    if (header.type != FrameCodec::MessageType::Data) {
+      handleControlFrame(header.type, payload, header.payloadSize);
+      m_receiveBuffer.consume(totalSize);
+      continue;
+    }
 
-    // 发出消息信号
-    if (!message.isEmpty()) {
-      qDebug() << "[ClientHandler]" << m_socketDescriptor
-               << "收到完整消息:" << message;
-      emit messageReceived(m_socketDescriptor, message);
+    // 提取消息内容（跳过帧头），保持原始字节；压缩帧先解压
+    QByteArray data;
+    if ((header.flags & FrameCodec::FLAG_COMPRESSED) != 0) {
+      if (!FrameCompression::decompress(payload, header.payloadSize, &data)) {
+        abortOnProtocolError("压缩帧解压失败，断开连接");
+        return;
+      }
+    } else {
+      data = QByteArray(payload, header.payloadSize);
     }
+
+    // 移动读游标（处理黏包），不移动剩余数据
+    m_receiveBuffer.consume(totalSize);
+    deliverMessage(data, readNs);
+  }
+
+  // 每次读取最多压缩一次（含缩容策略）
+  m_receiveBuffer.compact();
+}
+
+void ClientHandler::deliverMessage(const QByteArray &data, qint64 readNs) {
+  if (data.isEmpty()) {
+    return;
   }
 
-  // 缓冲区缩容策略：如果缓冲区空闲空间过大（>8KB）且已用空间较小，则缩容
-  constexpr int SHRINK_THRESHOLD = 8192;
-  if (m_receiveBuffer.capacity() > SHRINK_THRESHOLD &&
-      m_receiveBuffer.size() < 1024) {
-    QByteArray temp(m_receiveBuffer);
-    m_receiveBuffer = std::move(temp);
-    m_receiveBuffer.reserve(4096); // 恢复初始容量
+  NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+      << "[ClientHandler]" << m_clientId
+      << "收到完整消息 (字节数:" << data.size() << ")";
+  NET_DEBUG(lcNetPayload) << "[ClientHandler]" << m_clientId << "负载:"
+                          << NetLog::payloadPreview(data);
+  emit dataReceived(m_clientId, data);
+
+  // Worker 以直接连接处理该信号，返回时消息已发出或进入批次
+  if (m_counters) {
+    m_counters->messagesIn.fetch_add(1, std::memory_order_relaxed);
+    m_counters->dispatchLatency.record(LatencyHistogram::nowNs() - readNs);
   }
 }
 
+bool ClientHandler::handleChunkFrame(const FrameCodec::FrameHeader &header,
+                                     const char *payload, qint64 readNs) {
+  quint32 streamId = 0;
+  if (!FrameCodec::readChunkStreamId(payload, header.payloadSize, &streamId)) {
+    abortOnProtocolError("分块帧格式错误，断开连接");
+    return false;
+  }
+
+  const bool last = (header.flags & FrameCodec::FLAG_FINAL) != 0;
+  qint64 offset = 0;
+  QByteArray data;
+  switch (m_chunks.feed(streamId, payload + FrameCodec::CHUNK_ID_SIZE,
+                        header.payloadSize - FrameCodec::CHUNK_ID_SIZE, last,
+                        &offset, &data)) {
+  case ChunkAssembler::Result::Chunk:
+    emit messageChunk(m_clientId, streamId, offset, data, last);
+    if (last && m_counters) {
+      m_counters->messagesIn.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+  case ChunkAssembler::Result::Message:
+    deliverMessage(data, readNs);
+    return true;
+  case ChunkAssembler::Result::Pending:
+    return true;
+  case ChunkAssembler::Result::Error:
+  default:
+    abortOnProtocolError("分块消息过多或过大，断开连接");
+    return false;
+  }
+}
+
+void ClientHandler::abortOnProtocolError(const QString &error) {
+  NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId << error;
+  if (m_counters) {
+    m_counters->parseErrors.fetch_add(1, std::memory_order_relaxed);
+  }
+  emit errorOccurred(m_clientId, error);
+  m_socket->disconnectFromHost();
+}
+
+void ClientHandler::sendPing() {
+  if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState ||
+      m_aborting) {
+    return;
+  }
+
+  if (m_unansweredPings >= qMax(1, m_heartbeat.maxMissed)) {
+    NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId << "连续"
+                         << m_unansweredPings << "次心跳未应答，判定对端失联";
+    if (m_counters) {
+      m_counters->heartbeatTimeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+    emit errorOccurred(m_clientId, "心跳超时，断开连接");
+    abort();
+    return;
+  }
+
+  ++m_unansweredPings;
+  writeControlFrame(
+      FrameCodec::packPing(RttEstimator::nowNs(), m_protocolVersion));
+}
+
+void ClientHandler::handleControlFrame(FrameCodec::MessageType type,
+                                       const char *payload, qsizetype size) {
+  qint64 timestampNs = 0;
+  int peerVersion = 0;
+  quint8 features = 0;
+  switch (type) {
+  case FrameCodec::MessageType::Hello:
+    // 取双方都支持的最高版本和共同特性；回复仍是 v1 控制帧，
+    // 发出后本端改用新版本
+    if (FrameCodec::readHello(payload, size, &peerVersion, &features)) {
+      const int version = qMin(peerVersion, FrameCodec::LATEST_VERSION);
+      m_peerFeatures = features & FrameCodec::SUPPORTED_FEATURES;
+      writeControlFrame(FrameCodec::packHello(version, m_peerFeatures));
+      m_protocolVersion = version;
+      NET_DEBUG(lcNetIo) << "[ClientHandler]" << m_clientId
+                         << "协商协议版本:" << version;
+    }
+    break;
+  case FrameCodec::MessageType::Ping:
+    // 原样回显对端的时间戳
+    if (FrameCodec::readTimestamp(payload, size, &timestampNs)) {
+      writeControlFrame(FrameCodec::packPong(timestampNs, m_protocolVersion));
+    }
+    break;
+  case FrameCodec::MessageType::Pong:
+    if (FrameCodec::readTimestamp(payload, size, &timestampNs)) {
+      const qint64 sampleNs = RttEstimator::nowNs() - timestampNs;
+      if (sampleNs >= 0) {
+        m_rtt.addSample(sampleNs);
+        if (m_counters) {
+          m_counters->rtt.record(sampleNs);
+        }
+        updateRttGauge();
+      }
+    }
+    break;
+  default:
+    // 未知类型的控制帧直接忽略，便于以后扩展
+    NET_DEBUG_LIMITED(lcNetIo, m_logLimiter)
+        << "[ClientHandler]" << m_clientId << "忽略未知控制帧类型:"
+        << static_cast<int>(type);
+    break;
+  }
+}
+
+void ClientHandler::writeControlFrame(const QByteArray &packet) {
+  if (!m_socket || m_socket->state() != QAbstractSocket::ConnectedState ||
+      m_aborting) {
+    return;
+  }
+
+  m_socket->write(packet);
+  m_socket->flush();
+  updatePendingGauge();
+}
+
+void ClientHandler::updateRttGauge() {
+  if (!m_counters) {
+    return;
+  }
+
+  // 与待发送字节数相同，只提交差值；第一次测得 RTT 时计入连接数
+  const qint64 rtt = m_rtt.smoothedNs();
+  if (m_reportedRtt == 0 && rtt > 0) {
+    m_counters->rttClients.fetch_add(1, std::memory_order_relaxed);
+  }
+  m_counters->rttSumNs.fetch_add(rtt - m_reportedRtt,
+                                 std::memory_order_relaxed);
+  m_reportedRtt = rtt;
+}
+
 void ClientHandler::onReadyRead() { parseReceivedData(); }
 
+void ClientHandler::onBytesWritten(qint64 bytes) {
+  touch();
+  if (m_counters) {
+    m_counters->bytesOut.fetch_add(static_cast<quint64>(bytes),
+                                   std::memory_order_relaxed);
+  }
+
+  if (hasSendQueueLimits()) {
+    // socket 缓冲已回落，继续写出出站队列中的数据
+    flushPendingWrites();
+
+    // 回落到低水位以下时通知一次
+    if (m_sendQueueHigh && pendingSendBytes() <= m_sendLimits.lowWaterMark) {
+      m_sendQueueHigh = false;
+      emit sendQueueDrained(m_clientId);
+    }
+  }
+
+  updatePendingGauge();
+}
+
 void ClientHandler::onDisconnected() {
-  qDebug() << "[ClientHandler]" << m_socketDescriptor << "断开连接";
+  NET_DEBUG(lcNetIo) << "[ClientHandler]" << m_clientId << "断开连接";
   m_receiveBuffer.clear();
-  emit disconnected(m_socketDescriptor);
+  m_chunks.clear();
+  m_writeCoalescer.clear();
+
+  // 归还已计入 Worker 计数器的待发送字节数
+  if (m_counters) {
+    m_counters->pendingSendBytes.fetch_sub(m_reportedPending,
+                                           std::memory_order_relaxed);
+  }
+  m_reportedPending = 0;
+  if (m_counters && m_reportedRtt > 0) {
+    m_counters->rttSumNs.fetch_sub(m_reportedRtt, std::memory_order_relaxed);
+    m_counters->rttClients.fetch_sub(1, std::memory_order_relaxed);
+  }
+  m_reportedRtt = 0;
 
-  // 延迟删除自己
-  deleteLater();
+  // Worker 收到通知后回收或删除本对象
+  emit disconnected(m_clientId);
 }
 
 void ClientHandler::onError(QAbstractSocket::SocketError socketError) {
   // 过滤远程主机关闭连接，这不是错误
   if (socketError == QAbstractSocket::RemoteHostClosedError) {
-    qDebug() << "[ClientHandler]" << m_socketDescriptor << "远程主机关闭连接";
+    NET_DEBUG(lcNetIo) << "[ClientHandler]" << m_clientId << "远程主机关闭连接";
     return;
   }
 
   QString errorString = m_socket->errorString();
-  qWarning() << "[ClientHandler]" << m_socketDescriptor
-             << "错误:" << errorString;
-  emit errorOccurred(m_socketDescriptor, errorString);
+  NET_WARNING(lcNetIo) << "[ClientHandler]" << m_clientId
+                       << "错误:" << errorString;
+  emit errorOccurred(m_clientId, errorString);
 }
@@ -1,6 +1,18 @@
 #ifndef CLIENTHANDLER_H
 #define CLIENTHANDLER_H
 
+#include "ChunkAssembler.h"
+#include "ClientHandle.h"
+#include "FrameCodec.h"
+#include "FrameCompression.h"
+#include "Heartbeat.h"
+#include "NetLog.h"
+#include "ReceiveBuffer.h"
+#include "ServerStats.h"
+#include "ServerTypes.h"
+#include "SlabBufferPool.h"
+#include "TimingWheel.h"
+#include "WriteCoalescer.h"
 #include <QByteArray>
 #include <QObject>
 #include <QString>
@@ -12,49 +24,168 @@
  * 功能特性：
  * - 在独立线程中处理单个客户端的所有 I/O 操作
  * - 自动处理 TCP 黏包和半包问题
- * - 消息格式：[4字节长度(大端)][UTF-8消息内容]
+ * - 消息格式：v1 为 [4字节长度(大端)][消息内容]，对端发送 Hello 后协商为 v2
+ *   （见 FrameCodec），收到的两种版本的帧都能解码
  * - 线程安全的信号槽通信
+ * - 可选写合并：同一事件循环迭代内的出站帧合并为一次写入
+ * - 分块消息：可逐块发送任意长度的消息；接收时按流式模式逐块交付，
+ *   或拼接为完整消息后交付
+ * - 可选压缩：对端协商出 v2 并声明支持压缩时，超过阈值的数据帧压缩后发送
+ * - 可选发送队列水位控制：超过高水位时按策略丢弃或断开慢速客户端
+ * - 应答对端的 Hello 和 Ping；由 Worker 调度发送 Ping，测量 RTT 并检测失联的对端
  *
  * 生命周期：
- * - 在 I/O 线程中创建和销毁
+ * - 在 I/O 线程中创建和销毁，由所属 Worker 管理
+ * - 断开后不会删除自己：Worker 把它放回对象池，下次 initialize 时接管新连接
+ *   （socket 和信号连接被复用，接收缓冲区已归还缓冲池），或在池满时删除
  * - 通过队列连接的信号与主线程通信
  */
 class ClientHandler : public QObject {
   Q_OBJECT
 
 public:
-  explicit ClientHandler(qintptr socketDescriptor, QObject *parent = nullptr);
+  // 在 I/O 线程中创建，同时创建 socket 并连接其信号
+  explicit ClientHandler(QObject *parent = nullptr);
 
   ~ClientHandler() override;
 
   // 获取客户端 ID
-  qintptr clientId() const { return m_socketDescriptor; }
+  ClientId clientId() const { return m_clientId; }
 
   // 获取客户端地址
   QString clientAddress() const { return m_clientAddress; }
 
+  // 待发送字节数（socket 内部缓冲 + 尚未交给 socket 的排队数据）
+  qint64 pendingSendBytes() const;
+
+  // 因发送队列超限被丢弃的消息数
+  quint64 droppedMessageCount() const { return m_droppedMessages; }
+
+  // 与对端协商出的协议版本（对端没有发送 Hello 时为 v1）
+  int protocolVersion() const { return m_protocolVersion; }
+
+  // 对端是否能解码压缩帧（协商出 v2 且声明了压缩特性）
+  bool peerAcceptsCompression() const {
+    return m_protocolVersion >= FrameCodec::VERSION_2 &&
+           (m_peerFeatures & FrameCodec::FEATURE_COMPRESSION) != 0;
+  }
+
+  // 对端是否能接收分块消息（协商出 v2 且声明了分块特性）
+  bool peerAcceptsChunks() const {
+    return m_protocolVersion >= FrameCodec::VERSION_2 &&
+           (m_peerFeatures & FrameCodec::FEATURE_CHUNKS) != 0;
+  }
+
+  // 设置所属 Worker 的计数器（收发统计、待发送字节数和投递延迟）
+  void setCounters(WorkerCounters *counters) { m_counters = counters; }
+
+  // 设置所属 Worker 的接收缓冲池（空闲时不持有缓冲区，组装半包时借出）
+  void setBufferPool(SlabBufferPool *pool) { m_receiveBuffer.setPool(pool); }
+
+  // 设置所属 Worker 的空闲检测时间轮（读写活动时记录当前刻度）
+  void setIdleWheel(const TimingWheel *wheel) { m_idleWheel = wheel; }
+
+  // 最后一次读写活动的时间轮刻度
+  quint64 lastActivityTick() const { return m_lastActivityTick; }
+
+  // 设置心跳配置（Ping 由所属 Worker 统一调度发送）
+  void setHeartbeat(const HeartbeatOptions &options) { m_heartbeat = options; }
+
+  // 平滑后的 RTT（纳秒），尚未测得时为 0
+  qint64 smoothedRttNs() const { return m_rtt.smoothedNs(); }
+
+  // 发送一个 Ping；连续未应答的 Ping 已达上限时判定对端失联并中止连接
+  void sendPing();
+
+  // 记录一次读写活动（只保存当前刻度，O(1)）
+  void touch() {
+    if (m_idleWheel) {
+      m_lastActivityTick = m_idleWheel->currentTick();
+    }
+  }
+
+  // 按指定协议版本打包消息（v1 为 [4字节长度(大端)][消息内容]）
+  static QByteArray packMessage(const QByteArray &data,
+                                int version = FrameCodec::VERSION_1);
+
+  // 打包字符串消息（UTF-8 编码后打包）
+  static QByteArray packMessage(const QString &message,
+                                int version = FrameCodec::VERSION_1);
+
 public slots:
   // 发送消息（线程安全，通过队列连接调用）
   void sendMessage(const QString &message);
 
-  // 初始化连接（在目标线程中调用）
-  void initialize();
+  // 发送二进制数据（不经过 UTF-8 编解码）
+  void sendData(const QByteArray &data);
+
+  // 发送已打包好的数据包（不再重复编码，直接写入 socket）
+  void sendPacket(const QByteArray &packet);
+
+  // 发送广播帧（取本连接协议版本的数据包，同版本的连接共享同一个缓冲区）
+  void sendFrame(const FrameCodec::PreparedFrame &frame);
+
+  // 发送分块消息的一块（超过 MAX_CHUNK_SIZE 时自动拆分，last 表示消息结束）。
+  // 各块不会被水位策略丢弃（Disconnect 策略仍会断开），调用方应根据
+  // sendQueueHigh/sendQueueDrained 控制发送节奏；对端不支持分块时报错并丢弃
+  void sendChunk(quint32 streamId, const QByteArray &data, bool last);
+
+  // 发送 Goodbye（排在已排队的数据之后）。只发给协商过版本的连接，
+  // 旧版本的对端不认识控制帧
+  void sendGoodbye();
+
+  // 设置是否流式接收分块消息（只影响之后开始的流）
+  void setStreamingReceive(bool enabled) { m_chunks.setStreaming(enabled); }
+
+  // 写出写合并模式下缓存的所有数据包（一次 write + flush）
+  void flushPendingWrites();
+
+  // 设置写合并配置（关闭时会先写出已缓存的数据）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 设置发送队列水位和超限策略
+  void setSendQueueLimits(const SendQueueLimits &limits);
+
+  // 设置数据帧压缩配置（只影响单播，广播由线程池统一压缩）
+  void setCompression(const CompressionOptions &options) {
+    m_compression = options;
+  }
+
+  // 接管一个新连接（在目标线程中调用）。回收的处理器再次调用时
+  // 先清除上一个连接的全部状态，配置项（写合并、水位、心跳等）保持不变
+  void initialize(ClientId clientId, qintptr socketDescriptor);
 
   // 断开连接
   void disconnect();
 
+  // 立即中止连接（不等待待发送数据，用于空闲超时等场景）
+  void abort();
+
 signals:
   // 连接就绪（连接成功后发出）
-  void ready(qintptr clientId, const QString &address);
+  void ready(ClientId clientId, const QString &address);
 
-  // 接收到消息
-  void messageReceived(qintptr clientId, const QString &message);
+  // 接收到数据（原始二进制负载，不做 UTF-8 解码）
+  void dataReceived(ClientId clientId, const QByteArray &data);
+
+  // 流式接收模式下收到分块消息的一块（按顺序，offset 为本块在消息中的偏移）
+  void messageChunk(ClientId clientId, quint32 streamId, qint64 offset,
+                    const QByteArray &data, bool last);
 
   // 连接断开
-  void disconnected(qintptr clientId);
+  void disconnected(ClientId clientId);
+
+  // 写合并模式下有新的待写数据（由 Worker 统一调度写出）
+  void writePending(ClientId clientId);
+
+  // 待发送字节数超过高水位
+  void sendQueueHigh(ClientId clientId, qint64 pendingBytes);
+
+  // 待发送字节数回落到低水位以下
+  void sendQueueDrained(ClientId clientId);
 
   // 错误发生
-  void errorOccurred(qintptr clientId, const QString &error);
+  void errorOccurred(ClientId clientId, const QString &error);
 
 private slots:
   // 处理接收数据
@@ -63,20 +194,87 @@ private slots:
   // 处理断开连接
   void onDisconnected();
 
+  // 处理数据已写入内核，继续写出排队数据并检查低水位
+  void onBytesWritten(qint64 bytes);
+
   // 处理错误
   void onError(QAbstractSocket::SocketError socketError);
 
 private:
-  // 打包消息：[4字节长度(大端)][消息内容]
-  static QByteArray packMessage(const QString &message);
+  // 清除上一个连接的状态，准备接管新连接
+  void resetConnectionState();
 
   // 解析接收到的数据，处理黏包和半包
   void parseReceivedData();
 
-  qintptr m_socketDescriptor; // Socket 描述符
-  QTcpSocket *m_socket;       // TCP Socket（在目标线程中创建）
-  QByteArray m_receiveBuffer; // 接收缓冲区
+  // 把一条完整消息交给上层（readNs 为本次读取的时间点）
+  void deliverMessage(const QByteArray &data, qint64 readNs);
+
+  // 处理一个分块帧（内容已从接收缓冲区复制），返回 false 表示协议错误
+  bool handleChunkFrame(const FrameCodec::FrameHeader &header,
+                        const char *payload, qint64 readNs);
+
+  // 因协议错误断开连接
+  void abortOnProtocolError(const QString &error);
+
+  // 写入或排队一个数据包；droppable 为 false 时不会被水位策略丢弃
+  void enqueuePacket(const QByteArray &packet, bool droppable);
+
+  // 处理控制帧（应答 Hello 和 Ping，根据 Pong 更新 RTT）
+  void handleControlFrame(FrameCodec::MessageType type, const char *payload,
+                          qsizetype size);
+
+  // 直接写出控制帧（不经过写合并和水位控制，不计入消息数）
+  void writeControlFrame(const QByteArray &packet);
+
+  // 把平滑 RTT 的变化同步到 Worker 计数器
+  void updateRttGauge();
+
+  // 按协议版本、对端特性和压缩配置打包数据帧
+  QByteArray encodeData(const QByteArray &data);
+
+  // 记录一个压缩发送的数据帧
+  void recordCompressed(qsizetype originalSize, qsizetype compressedSize);
+
+  // 是否启用了发送队列水位控制
+  bool hasSendQueueLimits() const { return m_sendLimits.highWaterMark > 0; }
+
+  // 按水位和策略决定是否接受一个新数据包，返回 false 表示丢弃
+  // （不可丢弃的数据包只在 Disconnect 策略下被拒绝）
+  bool admitPacket(qint64 packetSize, bool droppable);
+
+  // 断开慢速客户端（延迟到下一次事件循环执行，避免在广播遍历中重入）
+  void abortSlowConsumer();
+
+  // 记录一条因超限被丢弃的消息
+  void recordDroppedMessage();
+
+  // 把待发送字节数的变化同步到 Worker 计数器
+  void updatePendingGauge();
+
+  ClientId m_clientId = ClientHandle::Invalid; // 客户端句柄（Worker 分配）
+  qintptr m_socketDescriptor = -1; // Socket 描述符
+  QTcpSocket *m_socket;            // TCP Socket（随处理器创建，回收后复用）
+  ReceiveBuffer m_receiveBuffer; // 接收缓冲区（读游标）
+  WriteCoalescer m_writeCoalescer; // 写合并缓存（同时作为出站队列）
+  SendQueueLimits m_sendLimits;    // 发送队列水位配置
+  quint64 m_droppedMessages = 0;   // 因超限被丢弃的消息数
+  bool m_sendQueueHigh = false;    // 是否处于高水位状态
+  bool m_aborting = false;         // 是否正在断开慢速客户端
   QString m_clientAddress;    // 客户端地址缓存
+  WorkerCounters *m_counters = nullptr; // 所属 Worker 的计数器
+  qint64 m_reportedPending = 0;         // 已计入 Worker 计数器的待发送字节数
+  const TimingWheel *m_idleWheel = nullptr; // 所属 Worker 的空闲检测时间轮
+  quint64 m_lastActivityTick = 0;           // 最后一次读写活动的刻度
+  HeartbeatOptions m_heartbeat;             // 心跳配置
+  RttEstimator m_rtt;                       // RTT 估计
+  int m_unansweredPings = 0;                // 连续未应答的 Ping 数
+  qint64 m_reportedRtt = 0;                 // 已计入 Worker 计数器的平滑 RTT
+  int m_protocolVersion = FrameCodec::VERSION_1; // 协商出的协议版本
+  quint8 m_peerFeatures = 0;                // 协商出的对端特性
+  CompressionOptions m_compression;         // 单播压缩配置
+  ChunkAssembler m_chunks;                  // 接收中的分块消息
+  LogRateLimiter m_logLimiter;          // 逐消息日志限流
 };
 
 #endif // CLIENTHANDLER_H
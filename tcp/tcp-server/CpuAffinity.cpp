@@ -0,0 +1,131 @@
+#include "CpuAffinity.h"
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <algorithm>
+#include <tuple>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+#ifdef Q_OS_LINUX
+// 读取 sysfs 中的整数，失败时返回 fallback
+int readSysInt(const QString &path, int fallback) {
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return fallback;
+  }
+  bool ok = false;
+  const int value = file.readAll().trimmed().toInt(&ok);
+  return ok ? value : fallback;
+}
+
+// CPU 所在的 NUMA 节点（cpuN/nodeM 链接），没有 NUMA 信息时为 0
+int numaNode(const QString &cpuPath) {
+  const QStringList nodes =
+      QDir(cpuPath).entryList({QStringLiteral("node*")}, QDir::Dirs);
+  for (const QString &node : nodes) {
+    bool ok = false;
+    const int index = node.mid(4).toInt(&ok);
+    if (ok) {
+      return index;
+    }
+  }
+  return 0;
+}
+#endif
+} // namespace
+
+bool CpuAffinity::isSupported() {
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+QList<int> CpuAffinity::availableCpus() {
+#ifdef Q_OS_LINUX
+  static const QList<int> cpus = []() {
+    QList<int> result;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+      return result;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        result.append(cpu);
+      }
+    }
+    return result;
+  }();
+  return cpus;
+#else
+  return {};
+#endif
+}
+
+QList<int> CpuAffinity::topologyOrder(const QList<int> &cpus) {
+#ifdef Q_OS_LINUX
+  // 排序键：(超线程序号, NUMA 节点, 封装, 核心, CPU 编号)
+  using Key = std::tuple<int, int, int, int, int>;
+  QList<Key> keys;
+  keys.reserve(cpus.size());
+
+  QList<std::tuple<int, int, int>> seenCores;
+  for (int cpu : cpus) {
+    const QString path = QString("/sys/devices/system/cpu/cpu%1/").arg(cpu);
+    const int node = numaNode(path);
+    const int package = readSysInt(path + "topology/physical_package_id", 0);
+    const int core = readSysInt(path + "topology/core_id", cpu);
+
+    // 同一物理核心已出现过的逻辑 CPU 数即为超线程序号
+    const auto physical = std::make_tuple(node, package, core);
+    const int smtIndex = static_cast<int>(seenCores.count(physical));
+    seenCores.append(physical);
+
+    keys.append(std::make_tuple(smtIndex, node, package, core, cpu));
+  }
+  std::sort(keys.begin(), keys.end());
+
+  QList<int> ordered;
+  ordered.reserve(keys.size());
+  for (const Key &key : std::as_const(keys)) {
+    ordered.append(std::get<4>(key));
+  }
+  return ordered;
+#else
+  return cpus;
+#endif
+}
+
+bool CpuAffinity::pinCurrentThread(const QList<int> &cpus) {
+#ifdef Q_OS_LINUX
+  if (cpus.isEmpty()) {
+    return false;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+
+  const int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  if (result != 0) {
+    qWarning() << "[CpuAffinity] 绑定 CPU 失败:" << cpus
+               << qt_error_string(result);
+    return false;
+  }
+  return true;
+#else
+  Q_UNUSED(cpus)
+  return false;
+#endif
+}
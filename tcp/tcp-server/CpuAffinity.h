@@ -0,0 +1,28 @@
+#ifndef CPUAFFINITY_H
+#define CPUAFFINITY_H
+
+#include <QList>
+
+/**
+ * @brief CPU 拓扑查询和线程绑定（仅 Linux，其他平台所有操作都是空操作）
+ *
+ * 拓扑信息来自 /sys/devices/system/cpu/cpuN/ 下的 topology/ 和 nodeM 目录，
+ * 读取失败时按 CPU 编号处理，不影响功能。
+ */
+namespace CpuAffinity {
+// 当前平台是否支持把线程绑定到 CPU
+bool isSupported();
+
+// 本进程可用的 CPU 编号（首次调用时读取 sched_getaffinity 并缓存，
+// 之后绑定线程不影响结果；受 taskset/cgroup 限制），不支持时返回空
+QList<int> availableCpus();
+
+// 按拓扑排序：每个物理核心的第一个逻辑 CPU 排在前面（同一 NUMA 节点、
+// 同一封装的核心相邻），超线程兄弟排在最后
+QList<int> topologyOrder(const QList<int> &cpus);
+
+// 把当前线程绑定到给定的 CPU 集合，失败返回 false
+bool pinCurrentThread(const QList<int> &cpus);
+} // namespace CpuAffinity
+
+#endif // CPUAFFINITY_H
@@ -1,17 +1,63 @@
 #include "IOThreadPool.h"
+#include "ClientHandler.h"
+#include "CpuAffinity.h"
 #include "IOThreadWorker.h"
+#include "NetLog.h"
 #include <QDebug>
+#include <QEventLoop>
+#include <QRandomGenerator>
+#include <QTimer>
 #include <algorithm>
 
-IOThreadPool::IOThreadPool(int threadCount, QObject *parent)
-    : QObject(parent), m_nextWorkerIndex(0), m_threadCount(threadCount) {
-  // 如果未指定线程数，使用 CPU 核心数
+// LeastLoad 策略的负载采样间隔（毫秒）和指数平滑系数
+constexpr int LOAD_SAMPLE_INTERVAL_MS = 1000;
+constexpr double LOAD_SMOOTHING = 0.5;
+
+// 每个 Worker 接收缓冲池默认保留的空闲容量
+constexpr qint64 DEFAULT_BUFFER_CACHE_LIMIT = 16 * 1024 * 1024;
+
+// drain 时采样发送队列的间隔（毫秒）
+constexpr int DRAIN_POLL_INTERVAL_MS = 10;
+
+// LeastLoad 策略中 RTT 修正系数的范围：RTT 高于平均值的线程（通常是事件循环
+// 忙碌，Pong 处理被推迟）负载按比例放大，但最多放大/缩小一倍
+constexpr double RTT_FACTOR_MIN = 0.5;
+constexpr double RTT_FACTOR_MAX = 2.0;
+
+namespace {
+// 创建一条提交给 Worker 的命令
+WorkerCommand *newCommand(WorkerCommand::Type type,
+                          ClientId clientId = ClientHandle::Invalid) {
+  auto *command = new WorkerCommand;
+  command->type = type;
+  command->clientId = clientId;
+  return command;
+}
+} // namespace
+
+IOThreadPool::IOThreadPool(int threadCount, PlacementStrategy strategy,
+                           QObject *parent)
+    : QObject(parent), m_idleTimeoutMs(0), m_streamingReceive(false),
+      m_bufferCacheLimit(DEFAULT_BUFFER_CACHE_LIMIT),
+      m_loadSampleTimer(new QTimer(this)), m_strategy(strategy),
+      m_nextWorkerIndex(0), m_threadCount(threadCount),
+      m_autoThreadCount(threadCount <= 0) {
+  // 如果未指定线程数，使用本进程可用的 CPU 数（受 taskset/cgroup 限制）
+  if (m_threadCount <= 0) {
+    m_threadCount = CpuAffinity::availableCpus().size();
+  }
   if (m_threadCount <= 0) {
     m_threadCount = static_cast<int>(std::thread::hardware_concurrency());
     if (m_threadCount <= 0) {
       m_threadCount = 4; // 默认值
     }
   }
+  // 客户端句柄中 Worker 索引的位数限制了线程数上限
+  m_threadCount = qMin(m_threadCount, ClientHandle::MAX_WORKERS);
+
+  m_loadSampleTimer->setInterval(LOAD_SAMPLE_INTERVAL_MS);
+  connect(m_loadSampleTimer, &QTimer::timeout, this,
+          &IOThreadPool::sampleWorkerLoad);
 
   qDebug() << "[IOThreadPool] 线程池大小:" << m_threadCount;
 }
@@ -24,14 +70,51 @@ void IOThreadPool::start() {
     return;
   }
 
+  // 规划 CPU 绑定：自动线程数时每个可用 CPU 一个线程
+  QList<int> reservedCpus;
+  const QList<int> ioCpus = planIoThreadCpus(&reservedCpus);
+  if (m_autoThreadCount && !ioCpus.isEmpty()) {
+    m_threadCount = qMin(static_cast<int>(ioCpus.size()),
+                         ClientHandle::MAX_WORKERS);
+  }
+  if (m_threadPolicy.pinMainThread && !reservedCpus.isEmpty() &&
+      CpuAffinity::pinCurrentThread(reservedCpus)) {
+    qDebug() << "[IOThreadPool] 主线程绑定到 CPU" << reservedCpus;
+  }
+
   // 创建并启动所有 I/O 线程和 Worker
   m_workers.reserve(m_threadCount);
   for (int i = 0; i < m_threadCount; ++i) {
     auto *thread = new QThread(this);
-    thread->setObjectName(QString("IOThread-%1").arg(i));
+    thread->setObjectName(
+        QString("%1-%2").arg(m_threadPolicy.threadNamePrefix).arg(i));
+
+    // 线程启动后在线程内部绑定 CPU（started 在新线程中发出）
+    if (!ioCpus.isEmpty()) {
+      const int cpu = ioCpus[i % ioCpus.size()];
+      connect(
+          thread, &QThread::started, thread,
+          [i, cpu]() {
+            if (CpuAffinity::pinCurrentThread({cpu})) {
+              qDebug() << "[IOThreadPool] 线程" << i << "绑定到 CPU" << cpu;
+            }
+          },
+          Qt::DirectConnection);
+    }
 
     // 创建 Worker 对象（负责业务逻辑）
     auto *worker = new IOThreadWorker(i);
+    worker->setBatchDelivery(m_batchOptions);
+    worker->setWriteCoalescing(m_writeOptions);
+    worker->setSendQueueLimits(m_sendLimits);
+    worker->setIdleTimeout(m_idleTimeoutMs);
+    worker->setHeartbeat(m_heartbeat);
+    worker->setCompression(m_compression);
+    worker->setStreamingReceive(m_streamingReceive);
+    worker->setMessageHandler(m_messageHandler);
+    worker->setAdmissionController(&m_admission);
+    worker->setHandlerPool(m_poolOptions);
+    worker->setReceiveBufferCacheLimit(m_bufferCacheLimit);
 
     // 将 Worker 移动到线程中
     worker->moveToThread(thread);
@@ -39,12 +122,20 @@ void IOThreadPool::start() {
     // 连接信号（使用队列连接，跨线程通信）
     connect(worker, &IOThreadWorker::clientReady, this,
             &IOThreadPool::clientReady, Qt::QueuedConnection);
-    connect(worker, &IOThreadWorker::messageReceived, this,
-            &IOThreadPool::messageReceived, Qt::QueuedConnection);
+    connect(worker, &IOThreadWorker::dataReceived, this,
+            &IOThreadPool::dataReceived, Qt::QueuedConnection);
+    connect(worker, &IOThreadWorker::messagesReceived, this,
+            &IOThreadPool::messagesReceived, Qt::QueuedConnection);
+    connect(worker, &IOThreadWorker::messageChunk, this,
+            &IOThreadPool::messageChunk, Qt::QueuedConnection);
     connect(worker, &IOThreadWorker::clientDisconnected, this,
-            &IOThreadPool::handleClientDisconnected, Qt::QueuedConnection);
+            &IOThreadPool::clientDisconnected, Qt::QueuedConnection);
     connect(worker, &IOThreadWorker::errorOccurred, this,
             &IOThreadPool::errorOccurred, Qt::QueuedConnection);
+    connect(worker, &IOThreadWorker::sendQueueHigh, this,
+            &IOThreadPool::sendQueueHigh, Qt::QueuedConnection);
+    connect(worker, &IOThreadWorker::sendQueueDrained, this,
+            &IOThreadPool::sendQueueDrained, Qt::QueuedConnection);
 
     // 线程结束时清理 Worker
     connect(thread, &QThread::finished, worker, &QObject::deleteLater);
@@ -58,9 +149,72 @@ void IOThreadPool::start() {
     qDebug() << "[IOThreadPool] 线程" << i << "已启动";
   }
 
+  // LeastLoad 策略需要周期性采样各 Worker 的收发速率
+  m_loadSamples = QList<LoadSample>(m_workers.size());
+  if (m_strategy == PlacementStrategy::LeastLoad) {
+    m_loadSampleClock.start();
+    m_loadSampleTimer->start();
+  }
+
   qDebug() << "[IOThreadPool] 启动完成，" << m_threadCount << "个线程";
 }
 
+DrainResult IOThreadPool::drain(int timeoutMs) {
+  DrainResult result;
+  if (m_workers.isEmpty()) {
+    return result;
+  }
+
+  const auto totalPending = [this]() {
+    qint64 bytes = 0;
+    for (const ThreadContext &ctx : m_workers) {
+      bytes += ctx.worker->counters().pendingSendBytes.load(
+          std::memory_order_relaxed);
+    }
+    return bytes;
+  };
+
+  qDebug() << "[IOThreadPool] 开始 drain，超时:" << timeoutMs << "毫秒";
+
+  // 阻塞等待每个 Worker 停止监听并排入 Goodbye，之后读取的待发送字节数
+  // 已包含 Goodbye 和此前提交的所有数据
+  for (const ThreadContext &ctx : m_workers) {
+    result.clients += ctx.worker->clientCount();
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::beginDrain,
+                              Qt::BlockingQueuedConnection);
+  }
+  const qint64 pendingAtStart = totalPending();
+
+  // 数据由各 I/O 线程的事件循环继续写出。调用线程不睡眠，而是在局部事件循环
+  // 中定时采样计数器，期间排队的断开、数据等信号照常投递，不会积压到
+  // serverStopped 之后
+  QElapsedTimer timer;
+  timer.start();
+  qint64 pending = totalPending();
+  if (pending > 0 && timeoutMs > 0) {
+    QEventLoop loop;
+    QTimer poll;
+    connect(&poll, &QTimer::timeout, &loop, [&]() {
+      pending = totalPending();
+      if (pending <= 0 || timer.elapsed() >= timeoutMs) {
+        loop.quit();
+      }
+    });
+    poll.start(DRAIN_POLL_INTERVAL_MS);
+    loop.exec();
+  }
+
+  result.completed = pending <= 0;
+  result.droppedBytes = qMax<qint64>(0, pending);
+  // 只统计开始时积压的数据：drain 期间连接仍可收发，新写出的字节不计入
+  result.flushedBytes = qMax<qint64>(0, pendingAtStart - pending);
+
+  stop();
+  qDebug() << "[IOThreadPool] drain 结束，写出" << result.flushedBytes
+           << "字节，丢弃" << result.droppedBytes << "字节";
+  return result;
+}
+
 void IOThreadPool::stop() {
   if (m_workers.isEmpty()) {
     return;
@@ -68,6 +222,8 @@ void IOThreadPool::stop() {
 
   qDebug() << "[IOThreadPool] 停止中...";
 
+  m_loadSampleTimer->stop();
+
   // 先清理所有 Worker 的客户端
   for (const auto &[_, worker] : m_workers) {
     QMetaObject::invokeMethod(worker, &IOThreadWorker::cleanup,
@@ -86,57 +242,297 @@ void IOThreadPool::stop() {
   }
 
   m_workers.clear();
-  m_clientWorkerMap.clear();
+  m_loadSamples.clear();
+  m_admission.reset();
   m_nextWorkerIndex.store(0, std::memory_order_relaxed);
 
   qDebug() << "[IOThreadPool] 已停止";
 }
 
 void IOThreadPool::addClient(qintptr socketDescriptor) {
-  // 使用轮询策略选择 Worker
+  // 先做准入检查，被拒绝的描述符直接关闭，不创建 QTcpSocket
+  quint64 admissionKey = AdmissionController::NO_KEY;
+  if (!m_admission.tryAdmit(socketDescriptor, &admissionKey)) {
+    NET_DEBUG(lcNetIo) << "[IOThreadPool] 拒绝连接" << socketDescriptor;
+    AdmissionController::closeDescriptor(socketDescriptor);
+    return;
+  }
+
+  // 按分配策略选择 Worker
   IOThreadWorker *selectedWorker = selectNextWorker();
   if (!selectedWorker) {
     qWarning() << "[IOThreadPool] 没有可用的 I/O Worker";
+    m_admission.release(admissionKey);
+    AdmissionController::closeDescriptor(socketDescriptor);
     return;
   }
 
-  // 记录客户端到 Worker 的映射
-  m_clientWorkerMap.insert(socketDescriptor, selectedWorker);
+  // 立即预占连接计数，连接风暴中后续的分配也能看到这个连接
+  selectedWorker->reserveClient();
 
-  // 添加客户端到选中的 Worker（通过队列连接调用）
+  // 添加客户端到选中的 Worker（通过队列连接调用，句柄由 Worker 分配）
   QMetaObject::invokeMethod(selectedWorker, &IOThreadWorker::addClient,
-                            Qt::QueuedConnection, socketDescriptor);
+                            Qt::QueuedConnection, socketDescriptor,
+                            admissionKey);
+
+  NET_DEBUG(lcNetIo) << "[IOThreadPool] 分配客户端" << socketDescriptor
+                     << "到 Worker" << selectedWorker->threadId();
+}
+
+quint16 IOThreadPool::startReusePortListeners(quint16 port) {
+  if (m_workers.isEmpty()) {
+    qWarning() << "[IOThreadPool] 线程池未启动";
+    return 0;
+  }
+
+  // 第一个 Worker 先绑定（端口 0 时由系统分配），其余 Worker 绑定同一个端口。
+  // 阻塞等待每个 Worker 在自己的线程中完成监听，保证返回时已全部就绪
+  quint16 boundPort = port;
+  for (const ThreadContext &ctx : m_workers) {
+    IOThreadWorker *worker = ctx.worker;
+    quint16 result = 0;
+    QMetaObject::invokeMethod(
+        worker,
+        [worker, boundPort]() { return worker->startListening(boundPort); },
+        Qt::BlockingQueuedConnection, &result);
+
+    if (result == 0) {
+      stopReusePortListeners();
+      return 0;
+    }
+    boundPort = result;
+  }
+
+  qDebug() << "[IOThreadPool] SO_REUSEPORT 监听端口:" << boundPort << "，"
+           << m_workers.size() << "个监听 socket";
+  return boundPort;
+}
 
-  qDebug() << "[IOThreadPool] 分配客户端" << socketDescriptor << "到 Worker"
-           << selectedWorker->threadId();
+void IOThreadPool::stopReusePortListeners() {
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::stopListening,
+                              Qt::BlockingQueuedConnection);
+  }
 }
 
-void IOThreadPool::sendMessage(qintptr clientId, const QString &message) {
-  // 查找客户端所在的 Worker
-  auto it = m_clientWorkerMap.find(clientId);
-  if (it != m_clientWorkerMap.end()) {
-    QMetaObject::invokeMethod(it.value(), &IOThreadWorker::sendMessageToClient,
-                              Qt::QueuedConnection, clientId, message);
+void IOThreadPool::sendData(ClientId clientId, const QByteArray &data) {
+  // 句柄直接给出所在的 Worker，过期句柄由 Worker 按代数拒绝
+  if (IOThreadWorker *worker = workerForClient(clientId)) {
+    // 由 Worker 按该连接协商出的协议版本打包
+    WorkerCommand *command =
+        newCommand(WorkerCommand::Type::SendData, clientId);
+    command->data = data;
+    worker->submit(command);
   } else {
-    qWarning() << "[IOThreadPool] 客户端" << clientId << "不存在";
+    NET_WARNING(lcNetIo) << "[IOThreadPool] 客户端" << clientId << "不存在";
+  }
+}
+
+void IOThreadPool::broadcastData(const QByteArray &data) {
+  // 在调用线程只压缩一次，并把每种帧格式各打包一次；所有 Worker 共享这些
+  // 数据帧（隐式共享），按连接的协议版本和压缩特性直接取用
+  const FrameCodec::PreparedFrame frame(
+      data, FrameCompression::compress(data, m_compression));
+  frame.packAll();
+  for (const ThreadContext &ctx : m_workers) {
+    WorkerCommand *command = newCommand(WorkerCommand::Type::BroadcastFrame);
+    command->frame = frame;
+    ctx.worker->submit(command);
   }
+  NET_DEBUG(lcNetIo) << "[IOThreadPool] 广播消息给所有 Worker";
+}
+
+void IOThreadPool::sendMessage(ClientId clientId, const QString &message) {
+  sendData(clientId, message.toUtf8());
 }
 
 void IOThreadPool::broadcastMessage(const QString &message) {
-  // 直接调用每个 Worker 的 broadcastMessage
+  broadcastData(message.toUtf8());
+}
+
+void IOThreadPool::subscribe(ClientId clientId, const QString &topic) {
+  if (IOThreadWorker *worker = workerForClient(clientId)) {
+    // 与发布走同一个队列，保证先订阅后发布的顺序
+    WorkerCommand *command =
+        newCommand(WorkerCommand::Type::Subscribe, clientId);
+    command->topic = topic;
+    worker->submit(command);
+  } else {
+    NET_WARNING(lcNetIo) << "[IOThreadPool] 客户端" << clientId << "不存在";
+  }
+}
+
+void IOThreadPool::unsubscribe(ClientId clientId, const QString &topic) {
+  if (IOThreadWorker *worker = workerForClient(clientId)) {
+    WorkerCommand *command =
+        newCommand(WorkerCommand::Type::Unsubscribe, clientId);
+    command->topic = topic;
+    worker->submit(command);
+  }
+}
+
+void IOThreadPool::publish(const QString &topic, const QByteArray &data) {
+  // 与广播相同：只压缩、打包一次，每个 Worker 只收到一个事件，在本线程内按主题
+  // 索引扇出。订阅索引只在各 Worker 中维护，没有订阅者的 Worker 只做一次哈希查找
+  const FrameCodec::PreparedFrame frame(
+      data, FrameCompression::compress(data, m_compression));
+  frame.packAll();
+  for (const ThreadContext &ctx : m_workers) {
+    WorkerCommand *command = newCommand(WorkerCommand::Type::PublishFrame);
+    command->topic = topic;
+    command->frame = frame;
+    ctx.worker->submit(command);
+  }
+}
+
+void IOThreadPool::sendChunk(ClientId clientId, quint32 streamId,
+                             const QByteArray &data, bool last) {
+  if (IOThreadWorker *worker = workerForClient(clientId)) {
+    WorkerCommand *command =
+        newCommand(WorkerCommand::Type::SendChunk, clientId);
+    command->streamId = streamId;
+    command->data = data;
+    command->last = last;
+    worker->submit(command);
+  } else {
+    NET_WARNING(lcNetIo) << "[IOThreadPool] 客户端" << clientId << "不存在";
+  }
+}
+
+void IOThreadPool::disconnectClient(ClientId clientId) {
+  if (IOThreadWorker *worker = workerForClient(clientId)) {
+    worker->submit(newCommand(WorkerCommand::Type::Disconnect, clientId));
+  }
+}
+
+void IOThreadPool::setBatchDelivery(const BatchDeliveryOptions &options) {
+  m_batchOptions = options;
   for (const ThreadContext &ctx : m_workers) {
-    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::broadcastMessage,
-                              Qt::QueuedConnection, message);
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setBatchDelivery,
+                              Qt::QueuedConnection, options);
   }
-  qDebug() << "[IOThreadPool] 广播消息给所有 Worker";
 }
 
-void IOThreadPool::disconnectClient(qintptr clientId) {
-  // 查找客户端所在的 Worker
-  auto it = m_clientWorkerMap.find(clientId);
-  if (it != m_clientWorkerMap.end()) {
-    QMetaObject::invokeMethod(it.value(), &IOThreadWorker::disconnectClient,
-                              Qt::QueuedConnection, clientId);
+void IOThreadPool::setWriteCoalescing(const WriteCoalescingOptions &options) {
+  m_writeOptions = options;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setWriteCoalescing,
+                              Qt::QueuedConnection, options);
+  }
+}
+
+void IOThreadPool::setSendQueueLimits(const SendQueueLimits &limits) {
+  m_sendLimits = limits;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setSendQueueLimits,
+                              Qt::QueuedConnection, limits);
+  }
+}
+
+void IOThreadPool::setIdleTimeout(int timeoutMs) {
+  m_idleTimeoutMs = qMax(0, timeoutMs);
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setIdleTimeout,
+                              Qt::QueuedConnection, m_idleTimeoutMs);
+  }
+}
+
+void IOThreadPool::setThreadPolicy(const ThreadPolicy &policy) {
+  if (!m_workers.isEmpty()) {
+    qWarning() << "[IOThreadPool] 线程池运行中，线程策略将在下次启动时生效";
+  }
+  m_threadPolicy = policy;
+  m_threadPolicy.reservedCpus = qMax(0, m_threadPolicy.reservedCpus);
+  if (m_threadPolicy.threadNamePrefix.isEmpty()) {
+    m_threadPolicy.threadNamePrefix = QStringLiteral("IOThread");
+  }
+}
+
+QList<int> IOThreadPool::planIoThreadCpus(QList<int> *reservedCpus) const {
+  if (m_threadPolicy.affinity == CpuAffinityMode::None) {
+    return {};
+  }
+  if (!CpuAffinity::isSupported()) {
+    qWarning() << "[IOThreadPool] 当前平台不支持 CPU 绑定，忽略线程策略";
+    return {};
+  }
+
+  // 候选 CPU：显式列表只保留本进程可用的 CPU
+  const QList<int> available = CpuAffinity::availableCpus();
+  QList<int> candidates;
+  if (m_threadPolicy.affinity == CpuAffinityMode::Explicit) {
+    for (int cpu : m_threadPolicy.cpus) {
+      if (available.contains(cpu) && !candidates.contains(cpu)) {
+        candidates.append(cpu);
+      }
+    }
+  } else {
+    candidates = CpuAffinity::topologyOrder(available);
+  }
+
+  // 至少给 I/O 线程留下一个 CPU
+  const qsizetype reserved =
+      qMin<qsizetype>(m_threadPolicy.reservedCpus, candidates.size() - 1);
+  if (reserved > 0) {
+    *reservedCpus = candidates.first(reserved);
+  }
+  const QList<int> ioCpus = candidates.mid(qMax<qsizetype>(0, reserved));
+
+  qDebug() << "[IOThreadPool] I/O 线程 CPU:" << ioCpus
+           << "，预留 CPU:" << *reservedCpus;
+  return ioCpus;
+}
+
+void IOThreadPool::setReceiveBufferCacheLimit(qint64 bytes) {
+  m_bufferCacheLimit = qMax<qint64>(0, bytes);
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker,
+                              &IOThreadWorker::setReceiveBufferCacheLimit,
+                              Qt::QueuedConnection, m_bufferCacheLimit);
+  }
+}
+
+void IOThreadPool::setHandlerPool(const HandlerPoolOptions &options) {
+  m_poolOptions = options;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setHandlerPool,
+                              Qt::QueuedConnection, options);
+  }
+}
+
+void IOThreadPool::setCompression(const CompressionOptions &options) {
+  m_compression = options;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setCompression,
+                              Qt::QueuedConnection, options);
+  }
+}
+
+void IOThreadPool::setStreamingReceive(bool enabled) {
+  m_streamingReceive = enabled;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setStreamingReceive,
+                              Qt::QueuedConnection, enabled);
+  }
+}
+
+void IOThreadPool::setAdmissionControl(const AdmissionOptions &options) {
+  m_admission.setOptions(options);
+}
+
+void IOThreadPool::setMessageHandler(const MessageHandlerPtr &handler) {
+  m_messageHandler = handler;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setMessageHandler,
+                              Qt::QueuedConnection, handler);
+  }
+}
+
+void IOThreadPool::setHeartbeat(const HeartbeatOptions &options) {
+  m_heartbeat = options;
+  for (const ThreadContext &ctx : m_workers) {
+    QMetaObject::invokeMethod(ctx.worker, &IOThreadWorker::setHeartbeat,
+                              Qt::QueuedConnection, options);
   }
 }
 
@@ -148,21 +544,157 @@ int IOThreadPool::totalClientCount() const {
   return total;
 }
 
+ServerStats IOThreadPool::statsSnapshot() const {
+  ServerStats stats;
+  stats.admission = m_admission.snapshot();
+  stats.workers.reserve(m_workers.size());
+  for (const ThreadContext &ctx : m_workers) {
+    stats.workers.append(ctx.worker->statsSnapshot());
+  }
+  return stats;
+}
+
 IOThreadWorker *IOThreadPool::selectNextWorker() {
   if (m_workers.isEmpty()) {
     return nullptr;
   }
 
-  // 轮询策略：依次选择下一个 Worker
-  int index = m_nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) %
-              m_workers.size();
+  int index = 0;
+  switch (m_strategy) {
+  case PlacementStrategy::LeastConnections:
+    index = selectLeastConnections();
+    break;
+  case PlacementStrategy::LeastLoad:
+    index = selectLeastLoad();
+    break;
+  case PlacementStrategy::PowerOfTwoChoices:
+    index = selectPowerOfTwoChoices();
+    break;
+  case PlacementStrategy::RoundRobin:
+  default:
+    index = selectRoundRobin();
+    break;
+  }
   return m_workers[index].worker;
 }
 
-void IOThreadPool::handleClientDisconnected(qintptr clientId) {
-  // 从映射表中移除
-  m_clientWorkerMap.remove(clientId);
+IOThreadWorker *IOThreadPool::workerForClient(ClientId clientId) const {
+  if (clientId == ClientHandle::Invalid) {
+    return nullptr;
+  }
+  const int index = ClientHandle::workerIndex(clientId);
+  return index < m_workers.size() ? m_workers[index].worker : nullptr;
+}
+
+int IOThreadPool::selectRoundRobin() {
+  // 轮询策略：依次选择下一个 Worker
+  return m_nextWorkerIndex.fetch_add(1, std::memory_order_relaxed) %
+         m_workers.size();
+}
+
+int IOThreadPool::selectLeastConnections() {
+  // 从轮询位置开始扫描，连接数相同时依次轮换，避免总是选中第一个
+  const int count = m_workers.size();
+  const int start = selectRoundRobin();
+  int best = start;
+  int bestClients = m_workers[start].worker->clientCount();
+  for (int offset = 1; offset < count; ++offset) {
+    const int index = (start + offset) % count;
+    const int clients = m_workers[index].worker->clientCount();
+    if (clients < bestClients) {
+      best = index;
+      bestClients = clients;
+    }
+  }
+  return best;
+}
 
-  // 转发信号
-  emit clientDisconnected(clientId);
+int IOThreadPool::selectLeastLoad() {
+  // 负载 = 平滑后的收发速率 + 上次采样以来新分配连接的预估负载。
+  // 采样间隔内速率不会变化，不加预估会把一秒内的所有新连接都分给同一个线程
+  double totalRate = 0.0;
+  int totalClients = 0;
+  qint64 totalRtt = 0;
+  int rttWorkers = 0;
+  for (int i = 0; i < m_workers.size(); ++i) {
+    totalRate += m_loadSamples[i].bytesPerSec;
+    totalClients += m_workers[i].worker->clientCount();
+    if (m_loadSamples[i].rttNs > 0) {
+      totalRtt += m_loadSamples[i].rttNs;
+      ++rttWorkers;
+    }
+  }
+  const double ratePerClient = totalRate / qMax(1, totalClients);
+  const double averageRtt =
+      rttWorkers > 0 ? static_cast<double>(totalRtt) / rttWorkers : 0.0;
+
+  const int count = m_workers.size();
+  const int start = selectRoundRobin();
+  int best = -1;
+  double bestScore = 0.0;
+  int bestClients = 0;
+  for (int offset = 0; offset < count; ++offset) {
+    const int index = (start + offset) % count;
+    const LoadSample &sample = m_loadSamples[index];
+    double score =
+        sample.bytesPerSec + ratePerClient * sample.assignedSinceSample;
+
+    // 启用心跳时按 RTT 相对平均值修正负载
+    if (sample.rttNs > 0 && averageRtt > 0.0) {
+      score *= qBound(RTT_FACTOR_MIN, sample.rttNs / averageRtt,
+                      RTT_FACTOR_MAX);
+    }
+    const int clients = m_workers[index].worker->clientCount();
+
+    // 负载相同（例如全部空闲）时退化为最少连接
+    if (best < 0 || score < bestScore ||
+        (score == bestScore && clients < bestClients)) {
+      best = index;
+      bestScore = score;
+      bestClients = clients;
+    }
+  }
+
+  ++m_loadSamples[best].assignedSinceSample;
+  return best;
+}
+
+int IOThreadPool::selectPowerOfTwoChoices() {
+  const int count = m_workers.size();
+  if (count == 1) {
+    return 0;
+  }
+
+  // 随机选两个不同的 Worker，取连接数较少者
+  QRandomGenerator *random = QRandomGenerator::global();
+  const int first = static_cast<int>(random->bounded(count));
+  int second = static_cast<int>(random->bounded(count - 1));
+  if (second >= first) {
+    ++second;
+  }
+
+  return m_workers[second].worker->clientCount() <
+                 m_workers[first].worker->clientCount()
+             ? second
+             : first;
+}
+
+void IOThreadPool::sampleWorkerLoad() {
+  const qint64 elapsedMs = m_loadSampleClock.restart();
+  if (elapsedMs <= 0) {
+    return;
+  }
+
+  for (int i = 0; i < m_workers.size(); ++i) {
+    LoadSample &sample = m_loadSamples[i];
+    const quint64 totalBytes = m_workers[i].worker->counters().totalBytes();
+    const double rate =
+        static_cast<double>(totalBytes - sample.lastBytes) * 1000.0 / elapsedMs;
+
+    sample.bytesPerSec =
+        LOAD_SMOOTHING * rate + (1.0 - LOAD_SMOOTHING) * sample.bytesPerSec;
+    sample.lastBytes = totalBytes;
+    sample.rttNs = m_workers[i].worker->counters().averageRttNs();
+    sample.assignedSinceSample = 0;
+  }
 }
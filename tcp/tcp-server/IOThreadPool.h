@@ -2,7 +2,9 @@
 #define IOTHREADPOOL_H
 
 #include "IOThreadWorker.h"
-#include <QHash>
+#include "ServerTypes.h"
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QList>
 #include <QObject>
 #include <QThread>
@@ -10,6 +12,7 @@
 #include <thread>
 
 class IOThreadWorker;
+class QTimer;
 
 /**
  * @brief I/O 线程池管理类
@@ -21,13 +24,20 @@ class IOThreadWorker;
  *
  * 功能特性：
  * - 管理多个 I/O 工作线程和 Worker
- * - 使用轮询（Round Robin）策略分配客户端连接
- * - 线程池大小可配置，默认基于 CPU 核心数
- * - 线程安全的客户端管理
+ * - 可选的连接分配策略（轮询 / 最少连接 / 最低负载 / 二选一）
+ * - 线程池大小可配置，默认基于本进程可用的 CPU 数
+ * - 可选线程策略：I/O 线程绑定到指定或按拓扑选择的 CPU，为主线程预留 CPU
+ * - 线程安全的客户端管理：客户端句柄编码了所属 Worker，路由无需查表
+ * - 发送、广播、发布、订阅和断开通过各 Worker 的无锁命令队列提交，
+ *   可在任意线程调用（start 之后、stop 之前），每批命令只唤醒一次 Worker
+ * - 可选 SO_REUSEPORT 模式：每个 Worker 持有自己的监听 socket，
+ *   由内核分发连接，分配策略在该模式下不生效
  *
  * 负载均衡：
- * - Round Robin：依次将新连接分配给各个线程
- * - 保证负载相对均衡
+ * - RoundRobin：依次将新连接分配给各个线程
+ * - LeastConnections：选择连接数最少的线程（基于 Worker 的原子连接计数）
+ * - LeastLoad：选择收发字节速率最低的线程（每秒采样一次，指数平滑）
+ * - PowerOfTwoChoices：随机选两个线程，取连接数较少者，开销恒定
  */
 class IOThreadPool : public QObject {
   Q_OBJECT
@@ -35,10 +45,14 @@ class IOThreadPool : public QObject {
 public:
   /**
    * @brief 构造函数
-   * @param threadCount 线程数量，0 表示使用 CPU 核心数
+   * @param threadCount 线程数量，0 表示使用本进程可用的 CPU 数
+   * @param strategy 新连接分配策略
    * @param parent 父对象
    */
-  explicit IOThreadPool(int threadCount = 0, QObject *parent = nullptr);
+  explicit IOThreadPool(
+      int threadCount = 0,
+      PlacementStrategy strategy = PlacementStrategy::RoundRobin,
+      QObject *parent = nullptr);
 
   ~IOThreadPool() override;
 
@@ -48,36 +62,127 @@ public:
   // 停止线程池
   void stop();
 
-  // 添加客户端连接（使用轮询策略分配）
+  // 优雅关闭：向所有客户端发送 Goodbye，等待发送队列清空或超时，然后停止线程池
+  // （最长 timeoutMs 毫秒后返回；等待期间调用线程运行局部事件循环）
+  DrainResult drain(int timeoutMs);
+
+  // 添加客户端连接（按分配策略选择 Worker）
   void addClient(qintptr socketDescriptor);
 
-  // 发送消息给指定客户端
-  void sendMessage(qintptr clientId, const QString &message);
+  // 在每个 Worker 中创建绑定同一端口的 SO_REUSEPORT 监听 socket，
+  // 返回实际监听端口（port 为 0 时由系统分配），失败时全部关闭并返回 0
+  quint16 startReusePortListeners(quint16 port);
+
+  // 关闭所有 Worker 的 SO_REUSEPORT 监听 socket
+  void stopReusePortListeners();
+
+  // 发送二进制数据给指定客户端
+  void sendData(ClientId clientId, const QByteArray &data);
+
+  // 广播二进制数据给所有客户端（只打包一次）
+  void broadcastData(const QByteArray &data);
 
-  // 广播消息给所有客户端
+  // 发送消息给指定客户端（UTF-8 编码后调用 sendData）
+  void sendMessage(ClientId clientId, const QString &message);
+
+  // 广播消息给所有客户端（UTF-8 编码后调用 broadcastData）
   void broadcastMessage(const QString &message);
 
+  // 客户端订阅主题（在客户端所在的 Worker 中登记）
+  void subscribe(ClientId clientId, const QString &topic);
+
+  // 客户端取消订阅主题
+  void unsubscribe(ClientId clientId, const QString &topic);
+
+  // 发布二进制数据给订阅了主题的客户端（只压缩一次，每个 Worker 一个事件）
+  void publish(const QString &topic, const QByteArray &data);
+
+  // 发送分块消息的一块给指定客户端
+  void sendChunk(ClientId clientId, quint32 streamId, const QByteArray &data,
+                 bool last);
+
   // 断开指定客户端
-  void disconnectClient(qintptr clientId);
+  void disconnectClient(ClientId clientId);
+
+  // 设置批量投递配置（可在运行时修改）
+  void setBatchDelivery(const BatchDeliveryOptions &options);
+
+  // 设置写合并配置（可在运行时修改）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 设置发送队列水位和超限策略（可在运行时修改）
+  void setSendQueueLimits(const SendQueueLimits &limits);
+
+  // 设置空闲超时（毫秒，0 表示不检测，可在运行时修改）
+  void setIdleTimeout(int timeoutMs);
+
+  // 获取空闲超时（毫秒）
+  int idleTimeout() const { return m_idleTimeoutMs; }
+
+  // 设置 I/O 线程的 CPU 亲和性和命名策略（在下次 start 时生效）
+  void setThreadPolicy(const ThreadPolicy &policy);
+
+  // 获取线程策略
+  ThreadPolicy threadPolicy() const { return m_threadPolicy; }
+
+  // 设置每个 Worker 接收缓冲池中空闲缓冲区的总容量上限（可在运行时修改）
+  void setReceiveBufferCacheLimit(qint64 bytes);
+
+  // 设置每个 Worker 的 ClientHandler 对象池（可在运行时修改）
+  void setHandlerPool(const HandlerPoolOptions &options);
+
+  // 设置心跳配置（可在运行时修改）
+  void setHeartbeat(const HeartbeatOptions &options);
+
+  // 设置数据帧压缩配置（广播在调用线程压缩一次，可在运行时修改）
+  void setCompression(const CompressionOptions &options);
+
+  // 设置是否流式接收分块消息（可在运行时修改，只影响之后开始的流）
+  void setStreamingReceive(bool enabled);
+
+  // 设置连接准入配置（全局上限、单地址上限、接受速率，可在运行时修改）
+  void setAdmissionControl(const AdmissionOptions &options);
+
+  // 设置在 I/O 线程中处理消息的处理器（所有 Worker 共享同一个对象）
+  void setMessageHandler(const MessageHandlerPtr &handler);
 
   // 获取线程池大小
   int threadCount() const { return m_workers.size(); }
 
+  // 获取连接分配策略
+  PlacementStrategy placementStrategy() const { return m_strategy; }
+
   // 获取总客户端数量
   int totalClientCount() const;
 
+  // 生成所有 Worker 的统计快照（只读取原子计数器，不打扰 I/O 线程）
+  ServerStats statsSnapshot() const;
+
 signals:
   // 客户端就绪
-  void clientReady(qintptr clientId, const QString &address);
+  void clientReady(ClientId clientId, const QString &address);
+
+  // 接收到数据（原始二进制负载）
+  void dataReceived(ClientId clientId, const QByteArray &data);
 
-  // 接收到消息
-  void messageReceived(qintptr clientId, const QString &message);
+  // 批量接收到的消息（启用批量投递时发出）
+  void messagesReceived(const ReceivedMessageList &messages);
+
+  // 流式接收模式下收到分块消息的一块
+  void messageChunk(ClientId clientId, quint32 streamId, qint64 offset,
+                    const QByteArray &data, bool last);
 
   // 客户端断开
-  void clientDisconnected(qintptr clientId);
+  void clientDisconnected(ClientId clientId);
+
+  // 客户端发送队列超过高水位
+  void sendQueueHigh(ClientId clientId, qint64 pendingBytes);
+
+  // 客户端发送队列回落到低水位以下
+  void sendQueueDrained(ClientId clientId);
 
   // 错误发生
-  void errorOccurred(qintptr clientId, const QString &error);
+  void errorOccurred(ClientId clientId, const QString &error);
 
 private:
   // 线程和 Worker 的组合
@@ -88,18 +193,55 @@ private:
     ThreadContext(QThread *t, IOThreadWorker *tw) : thread(t), worker(tw) {}
   };
 
-  // 根据轮询策略选择下一个 Worker
+  // 根据分配策略选择下一个 Worker
   IOThreadWorker *selectNextWorker();
 
+  // 按客户端句柄中的 Worker 索引定位 Worker，无效句柄返回 nullptr
+  IOThreadWorker *workerForClient(ClientId clientId) const;
+
+  // 按线程策略规划 I/O 线程使用的 CPU（不绑定时返回空），
+  // 预留给主线程的 CPU 写入 reservedCpus
+  QList<int> planIoThreadCpus(QList<int> *reservedCpus) const;
+
+  // 各策略的实现，返回 Worker 索引
+  int selectRoundRobin();
+  int selectLeastConnections();
+  int selectLeastLoad();
+  int selectPowerOfTwoChoices();
+
+  // 每个 Worker 的负载采样（LeastLoad 策略使用）
+  struct LoadSample {
+    quint64 lastBytes = 0;       // 上次采样时的收发总字节数
+    double bytesPerSec = 0.0;    // 指数平滑后的收发速率
+    qint64 rttNs = 0;            // 本线程连接的平均 RTT（启用心跳时）
+    int assignedSinceSample = 0; // 上次采样以来新分配的连接数
+  };
+
 private slots:
-  // 处理客户端断开，更新映射表
-  void handleClientDisconnected(qintptr clientId);
+  // 采样各 Worker 的收发速率
+  void sampleWorkerLoad();
 
 private:
   QList<ThreadContext> m_workers; // Worker 列表（包含线程和 Worker）
-  QHash<qintptr, IOThreadWorker *> m_clientWorkerMap; // 客户端到 Worker 的映射
+  BatchDeliveryOptions m_batchOptions;   // 批量投递配置
+  WriteCoalescingOptions m_writeOptions; // 写合并配置
+  SendQueueLimits m_sendLimits;          // 发送队列水位配置
+  int m_idleTimeoutMs;                   // 空闲超时（毫秒，0 为关闭）
+  HeartbeatOptions m_heartbeat;          // 心跳配置
+  CompressionOptions m_compression;      // 数据帧压缩配置
+  bool m_streamingReceive;               // 是否流式接收分块消息
+  MessageHandlerPtr m_messageHandler;    // I/O 线程中的消息处理器
+  AdmissionController m_admission;       // 连接准入控制（所有线程共用）
+  HandlerPoolOptions m_poolOptions;      // 处理器对象池配置
+  qint64 m_bufferCacheLimit;             // 接收缓冲池空闲容量上限
+  ThreadPolicy m_threadPolicy;           // CPU 亲和性和命名策略
+  QList<LoadSample> m_loadSamples;    // 每个 Worker 的负载采样
+  QTimer *m_loadSampleTimer;          // 负载采样定时器（LeastLoad 策略）
+  QElapsedTimer m_loadSampleClock;    // 采样间隔计时
+  PlacementStrategy m_strategy;       // 连接分配策略
   std::atomic<int> m_nextWorkerIndex; // 下一个 Worker 索引（轮询）
   int m_threadCount;                  // 线程数量
+  bool m_autoThreadCount;             // 线程数是否按 CPU 数自动确定
 };
 
 #endif // IOTHREADPOOL_H
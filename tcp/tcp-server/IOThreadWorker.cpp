@@ -1,10 +1,45 @@
 #include "IOThreadWorker.h"
 #include "ClientHandler.h"
+#include "NetLog.h"
+#include "ReusePortAcceptor.h"
 #include <QDebug>
+#include <QTcpSocket>
 #include <QThread>
+#include <QTimer>
+#include <utility>
+
+// 空闲超时被划分的刻度数（检测精度约为超时的 1/8）和最小刻度间隔（毫秒）
+constexpr int IDLE_TICKS_PER_TIMEOUT = 8;
+constexpr int IDLE_MIN_TICK_MS = 10;
+
+// 一个心跳间隔内的发送批次数：槽位按下标分成若干批轮流发送 Ping，
+// 避免同一时刻向所有连接写出
+constexpr int HEARTBEAT_PHASES = 8;
+
+// 一次唤醒最多执行的命令数，其余留到下一次事件循环迭代，避免饿死 socket 事件
+constexpr int MAX_COMMANDS_PER_DRAIN = 1024;
 
 IOThreadWorker::IOThreadWorker(int threadId, QObject *parent)
-    : QObject(parent), m_threadId(threadId), m_clientCount(0) {
+    : QObject(parent), m_batchTimer(new QTimer(this)),
+      m_writeFlushTimer(new QTimer(this)), m_idleTimer(new QTimer(this)),
+      m_idleTimeoutTicks(0), m_streamingReceive(false),
+      m_heartbeatTimer(new QTimer(this)), m_heartbeatPhase(0),
+      m_acceptor(nullptr), m_admission(nullptr), m_threadId(threadId),
+      m_clientCount(0) {
+  // 定时器随 Worker 一起 moveToThread，在工作线程中触发
+  m_batchTimer->setSingleShot(true);
+  connect(m_batchTimer, &QTimer::timeout, this, &IOThreadWorker::flushBatch);
+
+  m_writeFlushTimer->setSingleShot(true);
+  connect(m_writeFlushTimer, &QTimer::timeout, this,
+          &IOThreadWorker::flushPendingWrites);
+
+  connect(m_idleTimer, &QTimer::timeout, this,
+          &IOThreadWorker::checkIdleClients);
+
+  connect(m_heartbeatTimer, &QTimer::timeout, this,
+          &IOThreadWorker::sendHeartbeats);
+
   qDebug() << "[IOThreadWorker" << m_threadId << "] 创建";
 }
 
@@ -12,87 +47,651 @@ IOThreadWorker::~IOThreadWorker() {
   qDebug() << "[IOThreadWorker" << m_threadId << "] 析构";
 }
 
-void IOThreadWorker::addClient(qintptr socketDescriptor) {
+void IOThreadWorker::submit(WorkerCommand *command) {
+  if (m_commands.push(command)) {
+    scheduleDrain();
+  }
+}
+
+void IOThreadWorker::scheduleDrain() {
+  QMetaObject::invokeMethod(this, &IOThreadWorker::drainCommands,
+                            Qt::QueuedConnection);
+}
+
+void IOThreadWorker::drainCommands() {
+  // 先清除唤醒标志：处理期间新入队的命令会再投递一次唤醒
+  m_commands.beginDrain();
+  for (int processed = 0; processed < MAX_COMMANDS_PER_DRAIN; ++processed) {
+    WorkerCommand *command = m_commands.pop();
+    if (!command) {
+      return;
+    }
+    executeCommand(*command);
+    delete command;
+  }
+
+  // 本次达到上限，剩余命令在下一次事件循环迭代中处理
+  if (m_commands.requestWakeup()) {
+    scheduleDrain();
+  }
+}
+
+void IOThreadWorker::executeCommand(const WorkerCommand &command) {
+  switch (command.type) {
+  case WorkerCommand::Type::SendData:
+    sendDataToClient(command.clientId, command.data);
+    break;
+  case WorkerCommand::Type::SendChunk:
+    sendChunkToClient(command.clientId, command.streamId, command.data,
+                      command.last);
+    break;
+  case WorkerCommand::Type::BroadcastFrame:
+    broadcastFrame(command.frame);
+    break;
+  case WorkerCommand::Type::PublishFrame:
+    publishFrame(command.topic, command.frame);
+    break;
+  case WorkerCommand::Type::Subscribe:
+    subscribeClient(command.clientId, command.topic);
+    break;
+  case WorkerCommand::Type::Unsubscribe:
+    unsubscribeClient(command.clientId, command.topic);
+    break;
+  case WorkerCommand::Type::Disconnect:
+    disconnectClient(command.clientId);
+    break;
+  }
+}
+
+void IOThreadWorker::addClient(qintptr socketDescriptor,
+                               quint64 admissionKey) {
   // 通过队列连接调用，在工作线程的事件循环中执行
-  qDebug() << "[IOThreadWorker" << m_threadId << "] 添加客户端"
-           << socketDescriptor << "，运行在线程:" << QThread::currentThread();
+  NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 添加客户端"
+                     << socketDescriptor
+                     << "，运行在线程:" << QThread::currentThread();
 
-  // 在工作线程中创建 ClientHandler
-  ClientHandler *handler = new ClientHandler(socketDescriptor, this);
+  // 分配槽位和句柄
+  const ClientId clientId = allocateSlot();
+  if (clientId == ClientHandle::Invalid) {
+    qWarning() << "[IOThreadWorker" << m_threadId << "] 槽位已满，拒绝客户端"
+               << socketDescriptor;
+    // 接管描述符后立即关闭，并归还预占的连接计数
+    QTcpSocket socket;
+    if (socket.setSocketDescriptor(socketDescriptor)) {
+      socket.abort();
+    }
+    m_clientCount.fetch_sub(1, std::memory_order_release);
+    if (m_admission) {
+      m_admission->release(admissionKey);
+    }
+    return;
+  }
 
-  // 连接信号（直接连接，因为在同一线程）
-  connect(handler, &ClientHandler::ready, this, &IOThreadWorker::clientReady,
-          Qt::DirectConnection);
-  connect(handler, &ClientHandler::messageReceived, this,
-          &IOThreadWorker::messageReceived, Qt::DirectConnection);
-  connect(handler, &ClientHandler::disconnected, this,
-          &IOThreadWorker::handleClientDisconnected, Qt::DirectConnection);
-  connect(handler, &ClientHandler::errorOccurred, this,
-          &IOThreadWorker::errorOccurred, Qt::DirectConnection);
+  // 从对象池取出（或新建）处理器，每次都重新应用当前配置
+  ClientHandler *handler = acquireHandler();
+  handler->setWriteCoalescing(m_writeOptions);
+  handler->setSendQueueLimits(m_sendLimits);
+  handler->setCounters(&m_counters);
+  handler->setBufferPool(&m_bufferPool);
+  handler->setIdleWheel(&m_idleWheel);
+  handler->setHeartbeat(m_heartbeat);
+  handler->setCompression(m_compression);
+  handler->setStreamingReceive(m_streamingReceive);
+
+  // 保存到槽位（连接计数已由 IOThreadPool 在分配时通过 reserveClient 预占）
+  ClientSlot &entry = m_slots[ClientHandle::slotIndex(clientId)];
+  entry.handler = handler;
+  entry.admissionKey = admissionKey;
+  m_counters.accepts.fetch_add(1, std::memory_order_relaxed);
 
-  // 保存到映射表
-  m_clientHandlers.insert(socketDescriptor, handler);
-  m_clientCount.fetch_add(1, std::memory_order_release);
+  // 初始化连接（失败时处理器通过 disconnected 信号被回收）
+  handler->initialize(clientId, socketDescriptor);
 
-  // 初始化连接
-  handler->initialize();
+  // 加入空闲检测（初始化失败的连接句柄已过期，到期时会被丢弃）
+  if (m_idleTimeoutTicks > 0) {
+    m_idleWheel.schedule(clientId,
+                         m_idleWheel.currentTick() + m_idleTimeoutTicks);
+  }
 
-  qDebug() << "[IOThreadWorker" << m_threadId << "] 当前客户端数:"
-           << m_clientCount.load(std::memory_order_acquire);
+  NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 当前客户端数:"
+                     << m_clientCount.load(std::memory_order_acquire);
 }
 
-void IOThreadWorker::handleClientDisconnected(qintptr clientId) {
-  // 从映射表中移除
-  auto it = m_clientHandlers.find(clientId);
-  if (it != m_clientHandlers.end()) {
-    // ClientHandler 会自动 deleteLater，无需手动删除
-    m_clientHandlers.erase(it);
-    m_clientCount.fetch_sub(1, std::memory_order_release);
+quint16 IOThreadWorker::startListening(quint16 port) {
+  // 监听器在工作线程中创建，其 socket 通知由本线程的事件循环处理
+  if (!m_acceptor) {
+    m_acceptor = new ReusePortAcceptor(this);
+    connect(m_acceptor, &ReusePortAcceptor::connectionAccepted, this,
+            &IOThreadWorker::acceptClient, Qt::DirectConnection);
+  }
 
-    qDebug() << "[IOThreadWorker" << m_threadId << "] 移除客户端" << clientId
-             << "，当前客户端数:"
-             << m_clientCount.load(std::memory_order_acquire);
+  if (!m_acceptor->isListening() && !m_acceptor->listenReusePort(port)) {
+    qWarning() << "[IOThreadWorker" << m_threadId
+               << "] SO_REUSEPORT 监听失败:" << m_acceptor->lastError();
+    return 0;
   }
 
+  qDebug() << "[IOThreadWorker" << m_threadId << "] SO_REUSEPORT 监听端口:"
+           << m_acceptor->serverPort();
+  return m_acceptor->serverPort();
+}
+
+void IOThreadWorker::stopListening() {
+  if (!m_acceptor) {
+    return;
+  }
+
+  m_acceptor->close();
+  m_acceptor->deleteLater();
+  m_acceptor = nullptr;
+}
+
+void IOThreadWorker::acceptClient(qintptr socketDescriptor) {
+  // 连接由本线程接受，没有经过 IOThreadPool 的准入检查和分配，这里自行处理
+  quint64 admissionKey = AdmissionController::NO_KEY;
+  if (m_admission && !m_admission->tryAdmit(socketDescriptor, &admissionKey)) {
+    AdmissionController::closeDescriptor(socketDescriptor);
+    return;
+  }
+  reserveClient();
+  addClient(socketDescriptor, admissionKey);
+}
+
+void IOThreadWorker::handleClientDisconnected(ClientId clientId) {
+  // 先发出该客户端已解码的消息，保证消息先于断开通知到达
+  flushBatch();
+
+  // 释放槽位并回收处理器。重复的断开通知携带的句柄已过期，直接忽略
+  ClientHandler *handler = releaseSlot(clientId);
+  if (!handler) {
+    return;
+  }
+  recycleHandler(handler);
+  m_clientCount.fetch_sub(1, std::memory_order_release);
+  m_counters.disconnects.fetch_add(1, std::memory_order_relaxed);
+
+  NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 移除客户端"
+                     << clientId << "，当前客户端数:"
+                     << m_clientCount.load(std::memory_order_acquire);
+
   // 转发信号到外部
   emit clientDisconnected(clientId);
 }
 
-void IOThreadWorker::sendMessageToClient(qintptr clientId,
-                                         const QString &message) {
-  auto it = m_clientHandlers.find(clientId);
-  if (it != m_clientHandlers.end()) {
-    it.value()->sendMessage(message);
+void IOThreadWorker::sendDataToClient(ClientId clientId,
+                                      const QByteArray &data) {
+  if (ClientHandler *handler = findHandler(clientId)) {
+    handler->sendData(data);
   } else {
     qWarning() << "[IOThreadWorker" << m_threadId << "] 客户端" << clientId
                << "不存在";
   }
 }
 
-void IOThreadWorker::disconnectClient(qintptr clientId) {
-  auto it = m_clientHandlers.find(clientId);
-  if (it != m_clientHandlers.end()) {
-    it.value()->disconnect();
+void IOThreadWorker::publishFrame(const QString &topic,
+                                  const FrameCodec::PreparedFrame &frame) {
+  const auto it = m_topics.constFind(topic);
+  if (it == m_topics.constEnd()) {
+    return;
+  }
+
+  // 遍历订阅者集合的副本（隐式共享，不拷贝）：发送过程中客户端断开会修改索引
+  const QSet<ClientId> subscribers = it.value();
+  for (ClientId clientId : subscribers) {
+    if (ClientHandler *handler = findHandler(clientId)) {
+      handler->sendFrame(frame);
+    }
+  }
+  NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 发布主题"
+                     << topic << "给" << subscribers.size() << "个客户端";
+}
+
+void IOThreadWorker::subscribeClient(ClientId clientId, const QString &topic) {
+  if (!findHandler(clientId)) {
+    qWarning() << "[IOThreadWorker" << m_threadId << "] 客户端" << clientId
+               << "不存在";
+    return;
+  }
+
+  QSet<ClientId> &subscribers = m_topics[topic];
+  if (subscribers.contains(clientId)) {
+    return;
+  }
+  subscribers.insert(clientId);
+  m_slots[ClientHandle::slotIndex(clientId)].topics.append(topic);
+}
+
+void IOThreadWorker::unsubscribeClient(ClientId clientId,
+                                       const QString &topic) {
+  if (!findHandler(clientId)) {
+    return;
+  }
+  if (m_slots[ClientHandle::slotIndex(clientId)].topics.removeOne(topic)) {
+    removeSubscriber(topic, clientId);
+  }
+}
+
+void IOThreadWorker::sendChunkToClient(ClientId clientId, quint32 streamId,
+                                       const QByteArray &data, bool last) {
+  if (ClientHandler *handler = findHandler(clientId)) {
+    handler->sendChunk(streamId, data, last);
+  } else {
+    qWarning() << "[IOThreadWorker" << m_threadId << "] 客户端" << clientId
+               << "不存在";
+  }
+}
+
+void IOThreadWorker::disconnectClient(ClientId clientId) {
+  if (ClientHandler *handler = findHandler(clientId)) {
+    handler->disconnect();
+  }
+}
+
+void IOThreadWorker::broadcastFrame(const FrameCodec::PreparedFrame &frame) {
+  // 按下标遍历：发送过程中客户端可能断开并释放槽位，但槽位表不会收缩。
+  // 每个协议版本只打包一次，同版本的客户端复用同一个数据包（隐式共享，
+  // 无拷贝），水位策略逐个客户端生效
+  int recipients = 0;
+  for (qsizetype i = 0; i < m_slots.size(); ++i) {
+    if (ClientHandler *handler = m_slots[i].handler) {
+      handler->sendFrame(frame);
+      ++recipients;
+    }
+  }
+  NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 广播数据包给"
+                     << recipients << "个客户端";
+}
+
+void IOThreadWorker::handleDataReceived(ClientId clientId,
+                                        const QByteArray &data) {
+  // 注册了处理器时先在本线程处理，已处理的消息不再投递到主线程
+  if (m_messageHandler) {
+    if (ClientHandler *handler = findHandler(clientId)) {
+      if (m_messageHandler->handleMessage(MessageContext(this, handler),
+                                          data)) {
+        m_counters.messagesHandled.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+    }
+  }
+
+  if (!m_batchOptions.enabled) {
+    emit dataReceived(clientId, data);
+    return;
+  }
+
+  m_pendingBatch.append(ReceivedMessage{clientId, data});
+
+  // 达到批次上限立即发出，否则等待本次事件循环迭代结束（或刷新间隔）
+  if (m_pendingBatch.size() >= m_batchOptions.maxBatchSize) {
+    flushBatch();
+  } else if (!m_batchTimer->isActive()) {
+    m_batchTimer->start(m_batchOptions.flushIntervalMs);
   }
 }
 
-void IOThreadWorker::broadcastMessage(const QString &message) {
-  // 遍历本线程管理的所有客户端，发送消息
-  for (auto it = m_clientHandlers.begin(); it != m_clientHandlers.end(); ++it) {
-    it.value()->sendMessage(message);
+void IOThreadWorker::flushBatch() {
+  m_batchTimer->stop();
+  if (m_pendingBatch.isEmpty()) {
+    return;
+  }
+
+  ReceivedMessageList batch = std::exchange(m_pendingBatch, {});
+  m_pendingBatch.reserve(batch.size());
+  emit messagesReceived(batch);
+}
+
+void IOThreadWorker::handleMessageChunk(ClientId clientId, quint32 streamId,
+                                        qint64 offset, const QByteArray &data,
+                                        bool last) {
+  flushBatch();
+  emit messageChunk(clientId, streamId, offset, data, last);
+}
+
+void IOThreadWorker::setBatchDelivery(const BatchDeliveryOptions &options) {
+  // 关闭批量投递前先发出已缓存的消息
+  if (!options.enabled) {
+    flushBatch();
+  }
+
+  m_batchOptions = options;
+  m_batchOptions.maxBatchSize = qMax(1, m_batchOptions.maxBatchSize);
+  m_batchOptions.flushIntervalMs = qMax(0, m_batchOptions.flushIntervalMs);
+}
+
+void IOThreadWorker::scheduleWriteFlush(ClientId clientId) {
+  m_pendingWriteClients.append(clientId);
+  if (!m_writeFlushTimer->isActive()) {
+    m_writeFlushTimer->start(m_writeOptions.flushDelayMs);
+  }
+}
+
+void IOThreadWorker::flushPendingWrites() {
+  m_writeFlushTimer->stop();
+
+  // 已断开的客户端句柄已过期，直接跳过
+  const QList<ClientId> clients = std::exchange(m_pendingWriteClients, {});
+  for (ClientId clientId : clients) {
+    if (ClientHandler *handler = findHandler(clientId)) {
+      handler->flushPendingWrites();
+    }
   }
-  qDebug() << "[IOThreadWorker" << m_threadId << "] 广播消息给"
-           << m_clientHandlers.size() << "个客户端";
+}
+
+void IOThreadWorker::setWriteCoalescing(const WriteCoalescingOptions &options) {
+  m_writeOptions = options;
+  m_writeOptions.flushDelayMs = qMax(0, m_writeOptions.flushDelayMs);
+
+  // 关闭写合并时 ClientHandler 会先写出已缓存的数据
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setWriteCoalescing(m_writeOptions);
+    }
+  }
+  if (!m_writeOptions.enabled) {
+    m_writeFlushTimer->stop();
+    m_pendingWriteClients.clear();
+  }
+}
+
+void IOThreadWorker::setSendQueueLimits(const SendQueueLimits &limits) {
+  m_sendLimits = limits;
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setSendQueueLimits(m_sendLimits);
+    }
+  }
+}
+
+void IOThreadWorker::beginDrain() {
+  stopListening();
+  while (WorkerCommand *command = m_commands.pop()) {
+    executeCommand(*command);
+    delete command;
+  }
+
+  for (qsizetype i = 0; i < m_slots.size(); ++i) {
+    if (ClientHandler *handler = m_slots[i].handler) {
+      handler->sendGoodbye();
+    }
+  }
+  flushBatch();
+  flushPendingWrites();
 }
 
 void IOThreadWorker::cleanup() {
+  // 先停止接受新连接、空闲检测和心跳
+  stopListening();
+  m_idleTimer->stop();
+  m_heartbeatTimer->stop();
+  m_idleWheel.clear();
+
+  // 执行已提交的命令，发出尚未投递的批次，写出尚未发送的数据
+  while (WorkerCommand *command = m_commands.pop()) {
+    executeCommand(*command);
+    delete command;
+  }
+  flushBatch();
+  flushPendingWrites();
+
   // 清理所有客户端处理器（线程停止前调用）
   qDebug() << "[IOThreadWorker" << m_threadId << "] 清理"
-           << m_clientHandlers.size() << "个客户端";
+           << m_clientCount.load(std::memory_order_acquire) << "个客户端";
 
-  for (auto it = m_clientHandlers.begin(); it != m_clientHandlers.end(); ++it) {
-    it.value()->deleteLater();
+  // 处理器是本对象的子对象，可能晚于计数器和缓冲池析构，先解除引用
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setCounters(nullptr);
+      entry.handler->setBufferPool(nullptr);
+      entry.handler->deleteLater();
+    }
+  }
+  for (ClientHandler *handler : std::as_const(m_handlerPool)) {
+    handler->setCounters(nullptr);
+    handler->setBufferPool(nullptr);
+    handler->deleteLater();
   }
-  m_clientHandlers.clear();
+  m_handlerPool.clear();
+  m_counters.pooledHandlers.store(0, std::memory_order_relaxed);
+  m_counters.pendingSendBytes.store(0, std::memory_order_relaxed);
+  m_counters.rttSumNs.store(0, std::memory_order_relaxed);
+  m_counters.rttClients.store(0, std::memory_order_relaxed);
+  m_slots.clear();
+  m_freeSlots.clear();
+  m_topics.clear();
   m_clientCount.store(0, std::memory_order_release);
 }
+
+void IOThreadWorker::setIdleTimeout(int timeoutMs) {
+  m_idleTimer->stop();
+  m_idleWheel.clear();
+  if (timeoutMs <= 0) {
+    m_idleTimeoutTicks = 0;
+    return;
+  }
+
+  // 刻度间隔取超时的 1/8，超时换算为向上取整的刻度数
+  const int tickMs = qMax(IDLE_MIN_TICK_MS, timeoutMs / IDLE_TICKS_PER_TIMEOUT);
+  m_idleTimeoutTicks = static_cast<quint64>((timeoutMs + tickMs - 1) / tickMs);
+
+  // 刻度间隔可能已改变，现有连接从现在开始重新计时
+  const quint64 deadline = m_idleWheel.currentTick() + m_idleTimeoutTicks;
+  for (qsizetype i = 0; i < m_slots.size(); ++i) {
+    if (ClientHandler *handler = m_slots[i].handler) {
+      handler->touch();
+      m_idleWheel.schedule(handler->clientId(), deadline);
+    }
+  }
+  m_idleTimer->start(tickMs);
+}
+
+void IOThreadWorker::checkIdleClients() {
+  const QList<ClientId> due = m_idleWheel.advance();
+  const quint64 now = m_idleWheel.currentTick();
+
+  for (ClientId clientId : due) {
+    // 已断开的客户端句柄已过期，条目直接丢弃
+    ClientHandler *handler = findHandler(clientId);
+    if (!handler) {
+      continue;
+    }
+
+    // 期间有过活动：按新的截止刻度重新入轮
+    const quint64 deadline = handler->lastActivityTick() + m_idleTimeoutTicks;
+    if (deadline > now) {
+      m_idleWheel.schedule(clientId, deadline);
+      continue;
+    }
+
+    NET_DEBUG(lcNetIo) << "[IOThreadWorker" << m_threadId << "] 客户端"
+                       << clientId << "空闲超时，断开连接";
+    m_counters.idleTimeouts.fetch_add(1, std::memory_order_relaxed);
+    emit errorOccurred(clientId, "空闲超时，断开连接");
+    handler->abort();
+  }
+}
+
+void IOThreadWorker::setReceiveBufferCacheLimit(qint64 bytes) {
+  m_bufferPool.setMaxCachedBytes(bytes);
+}
+
+void IOThreadWorker::setHandlerPool(const HandlerPoolOptions &options) {
+  m_poolOptions.maxSize = qMax(0, options.maxSize);
+  m_poolOptions.warmSize = qBound(0, options.warmSize, m_poolOptions.maxSize);
+
+  // 缩小上限时删除多余的空闲处理器
+  while (m_handlerPool.size() > m_poolOptions.maxSize) {
+    m_handlerPool.takeLast()->deleteLater();
+  }
+  m_counters.pooledHandlers.store(static_cast<int>(m_handlerPool.size()),
+                                  std::memory_order_relaxed);
+
+  // 预热放到事件循环中执行：线程池启动前设置时，处理器在工作线程中创建
+  if (m_handlerPool.size() < m_poolOptions.warmSize) {
+    QMetaObject::invokeMethod(this, &IOThreadWorker::warmHandlerPool,
+                              Qt::QueuedConnection);
+  }
+}
+
+void IOThreadWorker::warmHandlerPool() {
+  // 直接创建新处理器入池；经 acquireHandler 会取出刚放入的同一个对象
+  const int target = qMin(m_poolOptions.warmSize, m_poolOptions.maxSize);
+  while (m_handlerPool.size() < target) {
+    m_handlerPool.append(createHandler());
+  }
+  m_counters.pooledHandlers.store(static_cast<int>(m_handlerPool.size()),
+                                  std::memory_order_relaxed);
+}
+
+ClientHandler *IOThreadWorker::acquireHandler() {
+  if (!m_handlerPool.isEmpty()) {
+    m_counters.handlersReused.fetch_add(1, std::memory_order_relaxed);
+    m_counters.pooledHandlers.fetch_sub(1, std::memory_order_relaxed);
+    return m_handlerPool.takeLast();
+  }
+  return createHandler();
+}
+
+ClientHandler *IOThreadWorker::createHandler() {
+  // 在工作线程中创建 ClientHandler
+  auto *handler = new ClientHandler(this);
+
+  // 连接信号（直接连接，因为在同一线程；处理器复用时不再重复连接）
+  connect(handler, &ClientHandler::ready, this, &IOThreadWorker::clientReady,
+          Qt::DirectConnection);
+  connect(handler, &ClientHandler::dataReceived, this,
+          &IOThreadWorker::handleDataReceived, Qt::DirectConnection);
+  connect(handler, &ClientHandler::messageChunk, this,
+          &IOThreadWorker::handleMessageChunk, Qt::DirectConnection);
+  connect(handler, &ClientHandler::disconnected, this,
+          &IOThreadWorker::handleClientDisconnected, Qt::DirectConnection);
+  connect(handler, &ClientHandler::errorOccurred, this,
+          &IOThreadWorker::errorOccurred, Qt::DirectConnection);
+  connect(handler, &ClientHandler::writePending, this,
+          &IOThreadWorker::scheduleWriteFlush, Qt::DirectConnection);
+  connect(handler, &ClientHandler::sendQueueHigh, this,
+          &IOThreadWorker::sendQueueHigh, Qt::DirectConnection);
+  connect(handler, &ClientHandler::sendQueueDrained, this,
+          &IOThreadWorker::sendQueueDrained, Qt::DirectConnection);
+  return handler;
+}
+
+void IOThreadWorker::recycleHandler(ClientHandler *handler) {
+  // 处理器可能仍在自己的断开回调中，这里只入池，状态在下次 initialize 时清除
+  if (m_handlerPool.size() < m_poolOptions.maxSize) {
+    m_handlerPool.append(handler);
+    m_counters.pooledHandlers.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    handler->deleteLater();
+  }
+}
+
+void IOThreadWorker::setCompression(const CompressionOptions &options) {
+  m_compression = options;
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setCompression(m_compression);
+    }
+  }
+}
+
+void IOThreadWorker::setStreamingReceive(bool enabled) {
+  m_streamingReceive = enabled;
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setStreamingReceive(enabled);
+    }
+  }
+}
+
+void IOThreadWorker::setMessageHandler(const MessageHandlerPtr &handler) {
+  m_messageHandler = handler;
+}
+
+void IOThreadWorker::setHeartbeat(const HeartbeatOptions &options) {
+  m_heartbeat = options;
+  m_heartbeat.intervalMs = qMax(0, m_heartbeat.intervalMs);
+  m_heartbeat.maxMissed = qMax(1, m_heartbeat.maxMissed);
+
+  for (const ClientSlot &entry : std::as_const(m_slots)) {
+    if (entry.handler) {
+      entry.handler->setHeartbeat(m_heartbeat);
+    }
+  }
+
+  m_heartbeatTimer->stop();
+  if (m_heartbeat.intervalMs > 0) {
+    const int phaseMs = m_heartbeat.intervalMs / HEARTBEAT_PHASES;
+    m_heartbeatTimer->start(qMax(1, phaseMs));
+  }
+}
+
+void IOThreadWorker::sendHeartbeats() {
+  // 每个连接在一个心跳间隔内恰好收到一个 Ping。按下标遍历：
+  // 失联的客户端会在 sendPing 中断开并释放槽位，但槽位表不会收缩
+  const int phase = m_heartbeatPhase;
+  m_heartbeatPhase = (m_heartbeatPhase + 1) % HEARTBEAT_PHASES;
+  for (qsizetype i = phase; i < m_slots.size(); i += HEARTBEAT_PHASES) {
+    if (ClientHandler *handler = m_slots[i].handler) {
+      handler->sendPing();
+    }
+  }
+}
+
+ClientHandler *IOThreadWorker::findHandler(ClientId clientId) const {
+  const quint32 slot = ClientHandle::slotIndex(clientId);
+  if (ClientHandle::workerIndex(clientId) != m_threadId ||
+      slot >= static_cast<quint32>(m_slots.size())) {
+    return nullptr;
+  }
+
+  const ClientSlot &entry = m_slots[slot];
+  return entry.generation == ClientHandle::generation(clientId) ? entry.handler
+                                                                : nullptr;
+}
+
+ClientId IOThreadWorker::allocateSlot() {
+  quint32 slot = 0;
+  if (!m_freeSlots.isEmpty()) {
+    slot = m_freeSlots.takeLast();
+  } else if (static_cast<quint32>(m_slots.size()) < ClientHandle::MAX_SLOTS) {
+    slot = static_cast<quint32>(m_slots.size());
+    m_slots.append(ClientSlot{});
+  } else {
+    return ClientHandle::Invalid;
+  }
+  return ClientHandle::make(m_threadId, slot, m_slots[slot].generation);
+}
+
+ClientHandler *IOThreadWorker::releaseSlot(ClientId clientId) {
+  ClientHandler *handler = findHandler(clientId);
+  if (!handler) {
+    return nullptr;
+  }
+
+  const quint32 slot = ClientHandle::slotIndex(clientId);
+  ClientSlot &entry = m_slots[slot];
+  for (const QString &topic : std::as_const(entry.topics)) {
+    removeSubscriber(topic, clientId);
+  }
+  entry.topics.clear();
+  if (m_admission) {
+    m_admission->release(entry.admissionKey);
+  }
+  entry.admissionKey = AdmissionController::NO_KEY;
+  entry.handler = nullptr;
+  entry.generation = ClientHandle::nextGeneration(entry.generation);
+  m_freeSlots.append(slot);
+  return handler;
+}
+
+void IOThreadWorker::removeSubscriber(const QString &topic, ClientId clientId) {
+  auto it = m_topics.find(topic);
+  if (it == m_topics.end()) {
+    return;
+  }
+  it.value().remove(clientId);
+  if (it.value().isEmpty()) {
+    m_topics.erase(it);
+  }
+}
@@ -1,11 +1,30 @@
 #ifndef IOTHREADWORKER_H
 #define IOTHREADWORKER_H
 
+#include "AdmissionController.h"
+#include "ClientHandle.h"
+#include "FrameCodec.h"
+#include "FrameCompression.h"
+#include "Heartbeat.h"
+#include "MessageHandler.h"
+#include "ServerStats.h"
+#include "ServerTypes.h"
+#include "SlabBufferPool.h"
+#include "TimingWheel.h"
+#include "WorkerCommandQueue.h"
+#include "WriteCoalescer.h"
+#include <QByteArray>
 #include <QHash>
+#include <QList>
 #include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
 #include <atomic>
 
 class ClientHandler;
+class ReusePortAcceptor;
+class QTimer;
 
 /**
  * @brief I/O 工作对象，运行在独立线程中
@@ -16,8 +35,20 @@ class ClientHandler;
  *
  * 功能特性：
  * - 管理分配给该线程的所有客户端连接
+ * - 客户端存放在槽位表中，句柄直接定位槽位，代数不匹配的过期句柄被拒绝
  * - 处理客户端的 I/O 操作和业务逻辑
  * - 线程安全的客户端添加和移除
+ * - 可选批量投递：一次事件循环迭代内解码的消息合并为一个信号发出
+ * - 可选写合并：一个定时器统一写出本线程所有客户端缓存的出站帧
+ * - 可选 SO_REUSEPORT 监听：本线程自行 accept，连接不再跨线程传递
+ * - 可选空闲超时：一个哈希时间轮和一个定时器检测本线程所有连接的空闲时间
+ * - 接收缓冲池：本线程所有连接按尺寸级别借用接收缓冲区，空闲连接不持有缓冲区
+ * - 可选对象池：断开的 ClientHandler 连同 socket 放回池中，新连接直接复用
+ * - 可选心跳：一个定时器分批向本线程所有连接发送 Ping，测量 RTT 并断开失联的对端
+ * - 可选消息处理器：在本线程直接处理消息并就地回复，不经过主线程往返
+ * - 主题订阅：本线程维护主题到本地订阅者的索引，发布的帧在本线程内扇出
+ * - 命令队列：任意线程通过无锁队列提交发送、广播、订阅和断开命令，
+ *   每批命令只唤醒一次事件循环
  *
  * 生命周期：
  * - 在主线程创建，moveToThread 到工作线程
@@ -34,46 +65,231 @@ public:
   // 获取线程 ID
   int threadId() const { return m_threadId; }
 
-  // 获取当前管理的客户端数量（线程安全）
+  // 获取当前管理的客户端数量（线程安全，包含已分配但尚未初始化的连接）
   int clientCount() const {
     return m_clientCount.load(std::memory_order_acquire);
   }
 
+  // 设置连接准入控制（在 moveToThread 之前调用，对象由线程池持有）。
+  // 本线程 SO_REUSEPORT 接受的连接在这里检查，所有连接断开时归还计数
+  void setAdmissionController(AdmissionController *controller) {
+    m_admission = controller;
+  }
+
+  // 为即将分配到本 Worker 的连接预占计数（在分配线程中调用，线程安全）
+  // 连接在事件循环中真正添加之前，负载均衡就能看到它
+  void reserveClient() { m_clientCount.fetch_add(1, std::memory_order_release); }
+
+  // 获取运行时计数器（线程安全，只读）
+  const WorkerCounters &counters() const { return m_counters; }
+
+  // 提交命令（线程安全，任意线程可调用，接管 command 的所有权）。
+  // 命令按提交顺序在工作线程中执行，队列从空闲变为非空时才唤醒事件循环
+  void submit(WorkerCommand *command);
+
+  // 生成统计快照（线程安全，只读取原子计数器）
+  WorkerStats statsSnapshot() const {
+    WorkerStats stats =
+        WorkerStats::fromCounters(m_threadId, clientCount(), m_counters);
+    stats.bufferPool = m_bufferPool.snapshot();
+    return stats;
+  }
+
 public slots:
-  // 添加客户端（在工作线程中执行）
-  void addClient(qintptr socketDescriptor);
+  // 添加客户端（在工作线程中执行），admissionKey 为准入时的地址键
+  void addClient(qintptr socketDescriptor, quint64 admissionKey);
+
+  // 发送数据给指定客户端（按该连接协商出的协议版本打包）
+  void sendDataToClient(ClientId clientId, const QByteArray &data);
+
+  // 广播帧（内容已由线程池压缩一次；本线程内每种帧格式只打包一次，
+  // 同格式的客户端共享同一个缓冲区）
+  void broadcastFrame(const FrameCodec::PreparedFrame &frame);
 
-  // 发送消息给指定客户端
-  void sendMessageToClient(qintptr clientId, const QString &message);
+  // 向本线程订阅了主题的客户端发送帧（帧格式的打包与广播相同）
+  void publishFrame(const QString &topic,
+                    const FrameCodec::PreparedFrame &frame);
 
-  // 广播消息给此 Worker 管理的所有客户端
-  void broadcastMessage(const QString &message);
+  // 客户端订阅主题（重复订阅无效果）
+  void subscribeClient(ClientId clientId, const QString &topic);
+
+  // 客户端取消订阅主题
+  void unsubscribeClient(ClientId clientId, const QString &topic);
+
+  // 发送分块消息的一块给指定客户端
+  void sendChunkToClient(ClientId clientId, quint32 streamId,
+                         const QByteArray &data, bool last);
 
   // 断开指定客户端
-  void disconnectClient(qintptr clientId);
+  void disconnectClient(ClientId clientId);
+
+  // 设置批量投递配置
+  void setBatchDelivery(const BatchDeliveryOptions &options);
+
+  // 设置写合并配置（应用到所有现有和新建的客户端）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 设置发送队列水位和超限策略（应用到所有现有和新建的客户端）
+  void setSendQueueLimits(const SendQueueLimits &limits);
+
+  // 设置空闲超时（毫秒，0 表示不检测），对现有连接从现在开始计时
+  void setIdleTimeout(int timeoutMs);
+
+  // 设置接收缓冲池中空闲缓冲区的总容量上限（字节）
+  void setReceiveBufferCacheLimit(qint64 bytes);
+
+  // 设置 ClientHandler 对象池（超出上限的空闲处理器被删除，不足预热数时补齐）
+  void setHandlerPool(const HandlerPoolOptions &options);
+
+  // 设置单播压缩配置（应用到所有现有和新建的客户端）
+  void setCompression(const CompressionOptions &options);
+
+  // 设置是否流式接收分块消息（应用到所有现有和新建的客户端）
+  void setStreamingReceive(bool enabled);
+
+  // 设置在本线程处理消息的处理器（为空表示全部投递到主线程）
+  void setMessageHandler(const MessageHandlerPtr &handler);
+
+  // 设置心跳配置（应用到所有现有和新建的客户端，间隔为 0 表示不发送 Ping）
+  void setHeartbeat(const HeartbeatOptions &options);
+
+  // 在本线程创建 SO_REUSEPORT 监听 socket，返回实际监听端口，失败返回 0
+  quint16 startListening(quint16 port);
+
+  // 关闭本线程的监听 socket（已接受的连接不受影响）
+  void stopListening();
+
+  // 开始优雅关闭：停止监听，执行已提交的命令，向所有客户端发送 Goodbye
+  // 并写出缓存的数据；之后连接保持打开，直到 cleanup
+  void beginDrain();
 
   // 清理所有客户端（线程停止前调用）
   void cleanup();
 
 signals:
   // 客户端就绪
-  void clientReady(qintptr clientId, const QString &address);
+  void clientReady(ClientId clientId, const QString &address);
 
-  // 接收到消息
-  void messageReceived(qintptr clientId, const QString &message);
+  // 接收到数据（原始二进制负载，未启用批量投递时发出）
+  void dataReceived(ClientId clientId, const QByteArray &data);
+
+  // 批量接收到的消息（启用批量投递时发出）
+  void messagesReceived(const ReceivedMessageList &messages);
+
+  // 流式接收模式下收到分块消息的一块
+  void messageChunk(ClientId clientId, quint32 streamId, qint64 offset,
+                    const QByteArray &data, bool last);
 
   // 客户端断开
-  void clientDisconnected(qintptr clientId);
+  void clientDisconnected(ClientId clientId);
+
+  // 客户端发送队列超过高水位
+  void sendQueueHigh(ClientId clientId, qint64 pendingBytes);
+
+  // 客户端发送队列回落到低水位以下
+  void sendQueueDrained(ClientId clientId);
 
   // 错误发生
-  void errorOccurred(qintptr clientId, const QString &error);
+  void errorOccurred(ClientId clientId, const QString &error);
 
 private slots:
+  // 处理本线程监听 socket 接受的新连接
+  void acceptClient(qintptr socketDescriptor);
+
   // 处理客户端断开（在工作线程中执行）
-  void handleClientDisconnected(qintptr clientId);
+  void handleClientDisconnected(ClientId clientId);
+
+  // 处理客户端收到的数据（先交给消息处理器，未处理的直接发出或加入当前批次）
+  void handleDataReceived(ClientId clientId, const QByteArray &data);
+
+  // 发出当前批次
+  void flushBatch();
+
+  // 执行命令队列中的命令（每次最多 MAX_COMMANDS_PER_DRAIN 条，其余再次唤醒）
+  void drainCommands();
+
+  // 转发分块消息的一块（先发出当前批次，保持与普通消息的顺序）
+  void handleMessageChunk(ClientId clientId, quint32 streamId, qint64 offset,
+                          const QByteArray &data, bool last);
+
+  // 记录有待写数据的客户端，并启动写出定时器
+  void scheduleWriteFlush(ClientId clientId);
+
+  // 写出所有客户端缓存的出站帧
+  void flushPendingWrites();
+
+  // 推进时间轮一个刻度，断开到期的空闲客户端
+  void checkIdleClients();
+
+  // 向本批次的客户端发送 Ping（每次只处理 1/HEARTBEAT_PHASES 的槽位）
+  void sendHeartbeats();
+
+  // 预先创建处理器，把对象池补齐到预热数
+  void warmHandlerPool();
 
 private:
-  QHash<qintptr, ClientHandler *> m_clientHandlers; // 客户端处理器映射
+  // 客户端槽位：句柄中的槽位索引直接定位，代数用于拒绝过期句柄
+  struct ClientSlot {
+    ClientHandler *handler = nullptr; // 占用该槽位的处理器（空闲时为空）
+    quint32 generation = 1;           // 当前代数，每次释放后递增
+    QStringList topics;               // 已订阅的主题（释放时据此清理索引）
+    quint64 admissionKey = AdmissionController::NO_KEY; // 准入地址键
+  };
+
+  // 从对象池取出一个处理器，池为空时调用 createHandler 新建
+  ClientHandler *acquireHandler();
+
+  // 新建处理器并连接信号（不经过对象池）
+  ClientHandler *createHandler();
+
+  // 断开的处理器放回对象池，池满时删除
+  void recycleHandler(ClientHandler *handler);
+
+  // 按句柄查找客户端处理器，句柄过期或不属于本 Worker 时返回 nullptr
+  ClientHandler *findHandler(ClientId clientId) const;
+
+  // 分配一个槽位并返回新句柄，槽位耗尽时返回 ClientHandle::Invalid
+  ClientId allocateSlot();
+
+  // 释放句柄对应的槽位并递增代数，同时取消其全部订阅，
+  // 返回原处理器（句柄过期时返回 nullptr）
+  ClientHandler *releaseSlot(ClientId clientId);
+
+  // 从主题索引中移除一个订阅者，主题没有订阅者时删除
+  void removeSubscriber(const QString &topic, ClientId clientId);
+
+  // 执行一条命令
+  void executeCommand(const WorkerCommand &command);
+
+  // 唤醒事件循环处理命令队列（每批只投递一个事件）
+  void scheduleDrain();
+
+  WorkerCommandQueue m_commands;                    // 跨线程命令队列
+  QList<ClientSlot> m_slots;                        // 客户端槽位表
+  QList<quint32> m_freeSlots;                       // 空闲槽位索引
+  QList<ClientHandler *> m_handlerPool;             // 空闲处理器对象池
+  QHash<QString, QSet<ClientId>> m_topics;          // 主题 → 本线程的订阅者
+  HandlerPoolOptions m_poolOptions;                 // 对象池配置
+  SlabBufferPool m_bufferPool;                      // 接收缓冲池
+  BatchDeliveryOptions m_batchOptions;              // 批量投递配置
+  ReceivedMessageList m_pendingBatch;               // 当前批次
+  QTimer *m_batchTimer;                             // 批次发出定时器
+  WriteCoalescingOptions m_writeOptions;            // 写合并配置
+  QList<ClientId> m_pendingWriteClients;            // 有待写数据的客户端
+  QTimer *m_writeFlushTimer;                        // 写出定时器
+  SendQueueLimits m_sendLimits;                     // 发送队列水位配置
+  TimingWheel m_idleWheel;                          // 空闲检测时间轮
+  QTimer *m_idleTimer;                              // 时间轮驱动定时器
+  quint64 m_idleTimeoutTicks;                       // 空闲超时（刻度数，0 为关闭）
+  HeartbeatOptions m_heartbeat;                     // 心跳配置
+  CompressionOptions m_compression;                 // 单播压缩配置
+  bool m_streamingReceive;                          // 是否流式接收分块消息
+  MessageHandlerPtr m_messageHandler;               // 本线程的消息处理器
+  QTimer *m_heartbeatTimer;                         // 心跳批次定时器
+  int m_heartbeatPhase;                             // 下一个心跳批次
+  ReusePortAcceptor *m_acceptor;                    // SO_REUSEPORT 监听器
+  AdmissionController *m_admission;                 // 连接准入控制（线程池持有）
+  WorkerCounters m_counters;                        // 运行时计数器
   int m_threadId;                                   // 线程 ID
   std::atomic<int> m_clientCount;                   // 客户端数量（原子变量）
 };
@@ -0,0 +1,31 @@
+#include "MessageHandler.h"
+#include "ClientHandler.h"
+#include "IOThreadWorker.h"
+
+MessageContext::MessageContext(IOThreadWorker *worker, ClientHandler *handler)
+    : m_worker(worker), m_handler(handler) {}
+
+ClientId MessageContext::clientId() const { return m_handler->clientId(); }
+
+QString MessageContext::clientAddress() const {
+  return m_handler->clientAddress();
+}
+
+int MessageContext::threadId() const { return m_worker->threadId(); }
+
+void MessageContext::reply(const QByteArray &data) const {
+  m_handler->sendData(data);
+}
+
+void MessageContext::reply(const QString &message) const {
+  m_handler->sendData(message.toUtf8());
+}
+
+void MessageContext::disconnect() const {
+  // 正处于该连接的解析循环中，立即断开会重入 Worker 并回收处理器，
+  // 因此按句柄排队执行（句柄过期时 Worker 会忽略）
+  auto *command = new WorkerCommand;
+  command->type = WorkerCommand::Type::Disconnect;
+  command->clientId = clientId();
+  m_worker->submit(command);
+}
@@ -0,0 +1,69 @@
+#ifndef MESSAGEHANDLER_H
+#define MESSAGEHANDLER_H
+
+#include "ClientHandle.h"
+#include <QByteArray>
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QString>
+
+class ClientHandler;
+class IOThreadWorker;
+
+/**
+ * @brief 在 I/O 线程中处理一条消息时的上下文
+ *
+ * 只在 MessageHandler::handleMessage 调用期间有效，不要保存或跨线程传递。
+ * reply 直接在当前 I/O 线程写入该连接（经过写合并和发送队列水位控制），
+ * 不经过主线程。
+ */
+class MessageContext {
+public:
+  MessageContext(IOThreadWorker *worker, ClientHandler *handler);
+
+  // 消息来源的客户端句柄
+  ClientId clientId() const;
+
+  // 客户端地址
+  QString clientAddress() const;
+
+  // 当前 I/O 线程的索引
+  int threadId() const;
+
+  // 回复二进制数据（按该连接协商出的协议版本打包）
+  void reply(const QByteArray &data) const;
+
+  // 回复字符串消息（UTF-8 编码后发送）
+  void reply(const QString &message) const;
+
+  // 断开该客户端（当前消息处理完毕后执行）
+  void disconnect() const;
+
+private:
+  IOThreadWorker *m_worker;
+  ClientHandler *m_handler;
+};
+
+/**
+ * @brief 在 I/O 线程中直接处理消息的处理器接口
+ *
+ * 通过 TCPServer::setMessageHandler 注册后，每条完整消息（含拼接完成的分块
+ * 消息，不含流式接收的分块）在解码它的 I/O 线程中调用 handleMessage，
+ * 可以就地回复，不再经过主线程往返。同一个对象被所有 I/O 线程并发调用，
+ * 实现必须是线程安全的，且不应阻塞（阻塞会延迟该线程上所有连接的读写）。
+ */
+class MessageHandler {
+public:
+  virtual ~MessageHandler() = default;
+
+  // 处理一条消息，返回 true 表示已处理（不再发出 dataReceived/messageReceived），
+  // 返回 false 时消息照常投递到主线程
+  virtual bool handleMessage(const MessageContext &context,
+                             const QByteArray &data) = 0;
+};
+
+using MessageHandlerPtr = QSharedPointer<MessageHandler>;
+
+Q_DECLARE_METATYPE(MessageHandlerPtr)
+
+#endif // MESSAGEHANDLER_H
@@ -0,0 +1,93 @@
+#include "ReusePortAcceptor.h"
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+ReusePortAcceptor::ReusePortAcceptor(QObject *parent) : QTcpServer(parent) {}
+
+ReusePortAcceptor::~ReusePortAcceptor() { close(); }
+
+bool ReusePortAcceptor::isSupported() {
+#ifdef Q_OS_LINUX
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool ReusePortAcceptor::listenReusePort(quint16 port) {
+#ifdef Q_OS_LINUX
+  // 优先创建双栈 IPv6 socket（与 QHostAddress::Any 行为一致），失败时退回 IPv4
+  bool ipv6 = true;
+  int fd = ::socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    ipv6 = false;
+    fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  }
+  if (fd < 0) {
+    m_lastError = QString("创建 socket 失败: %1").arg(qt_error_string(errno));
+    return false;
+  }
+
+  const int enable = 1;
+  const int disable = 0;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  if (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) !=
+      0) {
+    m_lastError =
+        QString("设置 SO_REUSEPORT 失败: %1").arg(qt_error_string(errno));
+    ::close(fd);
+    return false;
+  }
+
+  int result = 0;
+  if (ipv6) {
+    ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &disable, sizeof(disable));
+    sockaddr_in6 address{};
+    address.sin6_family = AF_INET6;
+    address.sin6_port = htons(port);
+    address.sin6_addr = in6addr_any;
+    result = ::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+  } else {
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    result = ::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+  }
+  if (result != 0) {
+    m_lastError = QString("绑定端口失败: %1").arg(qt_error_string(errno));
+    ::close(fd);
+    return false;
+  }
+
+  if (::listen(fd, SOMAXCONN) != 0) {
+    m_lastError = QString("监听失败: %1").arg(qt_error_string(errno));
+    ::close(fd);
+    return false;
+  }
+
+  // 交给 QTcpServer 管理，由本线程的事件循环通知新连接
+  if (!setSocketDescriptor(fd)) {
+    m_lastError = QString("设置监听 socket 失败: %1").arg(errorString());
+    ::close(fd);
+    return false;
+  }
+
+  m_lastError.clear();
+  return true;
+#else
+  Q_UNUSED(port)
+  m_lastError = "当前平台不支持 SO_REUSEPORT 监听模式";
+  return false;
+#endif
+}
+
+void ReusePortAcceptor::incomingConnection(qintptr socketDescriptor) {
+  emit connectionAccepted(socketDescriptor);
+}
@@ -0,0 +1,51 @@
+#ifndef REUSEPORTACCEPTOR_H
+#define REUSEPORTACCEPTOR_H
+
+#include <QString>
+#include <QTcpServer>
+
+/**
+ * @brief 基于 SO_REUSEPORT 的监听器，运行在 I/O 线程中
+ *
+ * 设计目的：
+ * - 每个 IOThreadWorker 拥有一个绑定同一端口的监听 socket
+ * - 由内核在各监听 socket 之间分发新连接，主线程不再参与 accept
+ * - 接受的连接直接在本线程处理，不再跨线程传递 socket 描述符
+ *
+ * 平台支持：
+ * - 仅 Linux（内核 3.9+）支持按 SO_REUSEPORT 做连接负载均衡
+ * - 其他平台 isSupported() 返回 false，listenReusePort() 总是失败
+ *
+ * 生命周期：
+ * - 在 I/O 线程中创建和销毁，由 IOThreadWorker 管理
+ */
+class ReusePortAcceptor : public QTcpServer {
+  Q_OBJECT
+
+public:
+  explicit ReusePortAcceptor(QObject *parent = nullptr);
+
+  ~ReusePortAcceptor() override;
+
+  // 当前平台是否支持 SO_REUSEPORT 监听模式
+  static bool isSupported();
+
+  // 创建带 SO_REUSEPORT 的监听 socket 并开始监听（端口 0 表示由系统分配）
+  bool listenReusePort(quint16 port);
+
+  // 最近一次失败的错误信息
+  QString lastError() const { return m_lastError; }
+
+signals:
+  // 接受到新连接（在 I/O 线程中发出）
+  void connectionAccepted(qintptr socketDescriptor);
+
+protected:
+  // 重写 QTcpServer 的虚函数，直接交出 socket 描述符
+  void incomingConnection(qintptr socketDescriptor) override;
+
+private:
+  QString m_lastError; // 错误信息
+};
+
+#endif // REUSEPORTACCEPTOR_H
@@ -0,0 +1,148 @@
+#include "ServerStats.h"
+#include <QtAlgorithms>
+#include <chrono>
+
+void LatencyHistogramSnapshot::merge(const LatencyHistogramSnapshot &other) {
+  if (counts.size() < other.counts.size()) {
+    counts.resize(other.counts.size());
+  }
+  for (qsizetype i = 0; i < other.counts.size(); ++i) {
+    counts[i] += other.counts[i];
+  }
+  totalCount += other.totalCount;
+}
+
+qint64 LatencyHistogramSnapshot::percentileNs(double quantile) const {
+  if (totalCount == 0) {
+    return 0;
+  }
+
+  // 第一个累计计数达到目标排名的桶
+  const double clamped = qBound(0.0, quantile, 1.0);
+  const quint64 rank =
+      qMax<quint64>(1, static_cast<quint64>(clamped * totalCount + 0.5));
+  quint64 cumulative = 0;
+  for (qsizetype i = 0; i < counts.size(); ++i) {
+    cumulative += counts[i];
+    if (cumulative >= rank) {
+      return static_cast<qint64>(
+          LatencyHistogram::bucketUpperBound(static_cast<int>(i)));
+    }
+  }
+  return static_cast<qint64>(
+      LatencyHistogram::bucketUpperBound(static_cast<int>(counts.size()) - 1));
+}
+
+qint64 LatencyHistogram::nowNs() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void LatencyHistogram::record(qint64 valueNs) {
+  const int index = bucketIndex(static_cast<quint64>(qMax<qint64>(0, valueNs)));
+  m_counts[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+LatencyHistogramSnapshot LatencyHistogram::snapshot() const {
+  LatencyHistogramSnapshot result;
+  result.counts.resize(BUCKET_COUNT);
+  for (int i = 0; i < BUCKET_COUNT; ++i) {
+    result.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+    result.totalCount += result.counts[i];
+  }
+  return result;
+}
+
+int LatencyHistogram::bucketIndex(quint64 value) {
+  // 小于子桶数的值各占一个桶（精确）
+  if (value < SUB_BUCKETS) {
+    return static_cast<int>(value);
+  }
+
+  // 数量级 = 最高有效位，子桶 = 最高位之后的 3 位
+  int magnitude = 63 - qCountLeadingZeroBits(value);
+  if (magnitude >= MAX_VALUE_BITS) {
+    return BUCKET_COUNT - 1;
+  }
+  const int shift = magnitude - SUB_BUCKET_BITS;
+  const int subBucket = static_cast<int>(value >> shift) - SUB_BUCKETS;
+  return (magnitude - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+quint64 LatencyHistogram::bucketUpperBound(int index) {
+  if (index < SUB_BUCKETS) {
+    return static_cast<quint64>(index);
+  }
+
+  const int magnitude = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+  const int subBucket = index % SUB_BUCKETS;
+  const int shift = magnitude - SUB_BUCKET_BITS;
+  return ((static_cast<quint64>(SUB_BUCKETS + subBucket + 1)) << shift) - 1;
+}
+
+WorkerStats WorkerStats::fromCounters(int workerIndex, int clientCount,
+                                      const WorkerCounters &counters) {
+  WorkerStats stats;
+  stats.workerIndex = workerIndex;
+  stats.clientCount = clientCount;
+  stats.bytesIn = counters.bytesIn.load(std::memory_order_relaxed);
+  stats.bytesOut = counters.bytesOut.load(std::memory_order_relaxed);
+  stats.messagesIn = counters.messagesIn.load(std::memory_order_relaxed);
+  stats.messagesOut = counters.messagesOut.load(std::memory_order_relaxed);
+  stats.messagesHandled =
+      counters.messagesHandled.load(std::memory_order_relaxed);
+  stats.accepts = counters.accepts.load(std::memory_order_relaxed);
+  stats.disconnects = counters.disconnects.load(std::memory_order_relaxed);
+  stats.parseErrors = counters.parseErrors.load(std::memory_order_relaxed);
+  stats.droppedMessages =
+      counters.droppedMessages.load(std::memory_order_relaxed);
+  stats.idleTimeouts = counters.idleTimeouts.load(std::memory_order_relaxed);
+  stats.heartbeatTimeouts =
+      counters.heartbeatTimeouts.load(std::memory_order_relaxed);
+  stats.handlersReused = counters.handlersReused.load(std::memory_order_relaxed);
+  stats.compressedOut = counters.compressedOut.load(std::memory_order_relaxed);
+  stats.compressionSavedBytes =
+      counters.compressionSavedBytes.load(std::memory_order_relaxed);
+  stats.pooledHandlers = counters.pooledHandlers.load(std::memory_order_relaxed);
+  stats.pendingSendBytes =
+      counters.pendingSendBytes.load(std::memory_order_relaxed);
+  stats.rttSumNs = counters.rttSumNs.load(std::memory_order_relaxed);
+  stats.rttClients = counters.rttClients.load(std::memory_order_relaxed);
+  stats.dispatchLatency = counters.dispatchLatency.snapshot();
+  stats.rtt = counters.rtt.snapshot();
+  return stats;
+}
+
+void WorkerStats::add(const WorkerStats &other) {
+  clientCount += other.clientCount;
+  bytesIn += other.bytesIn;
+  bytesOut += other.bytesOut;
+  messagesIn += other.messagesIn;
+  messagesOut += other.messagesOut;
+  messagesHandled += other.messagesHandled;
+  accepts += other.accepts;
+  disconnects += other.disconnects;
+  parseErrors += other.parseErrors;
+  droppedMessages += other.droppedMessages;
+  idleTimeouts += other.idleTimeouts;
+  heartbeatTimeouts += other.heartbeatTimeouts;
+  handlersReused += other.handlersReused;
+  compressedOut += other.compressedOut;
+  compressionSavedBytes += other.compressionSavedBytes;
+  pooledHandlers += other.pooledHandlers;
+  pendingSendBytes += other.pendingSendBytes;
+  rttSumNs += other.rttSumNs;
+  rttClients += other.rttClients;
+  dispatchLatency.merge(other.dispatchLatency);
+  rtt.merge(other.rtt);
+  bufferPool.add(other.bufferPool);
+}
+
+WorkerStats ServerStats::total() const {
+  WorkerStats result;
+  for (const WorkerStats &worker : workers) {
+    result.add(worker);
+  }
+  return result;
+}
@@ -0,0 +1,162 @@
+#ifndef SERVERSTATS_H
+#define SERVERSTATS_H
+
+#include "AdmissionController.h"
+#include "SlabBufferPool.h"
+#include <QList>
+#include <QMetaType>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+
+/**
+ * @brief 延迟直方图快照（普通值，可复制、可合并）
+ *
+ * 桶的划分与 LatencyHistogram 相同，用于计算分位数。
+ */
+struct LatencyHistogramSnapshot {
+  QList<quint64> counts; // 每个桶的计数
+  quint64 totalCount = 0; // 样本总数
+
+  // 合并另一个快照（用于跨 Worker 汇总）
+  void merge(const LatencyHistogramSnapshot &other);
+
+  // 计算分位数（0.0 ~ 1.0），返回桶上界（纳秒），没有样本时返回 0
+  qint64 percentileNs(double quantile) const;
+};
+
+/**
+ * @brief 无锁延迟直方图（HDR 风格的对数-线性分桶）
+ *
+ * - 按最高有效位分为若干数量级，每个数量级再线性分为 8 个子桶，
+ *   相对误差不超过 12.5%
+ * - 覆盖 0 ~ 2^40 纳秒（约 18 分钟），超出部分计入最后一个桶
+ * - 记录只有一次 relaxed 原子加，读取方拷贝快照后再计算分位数
+ */
+class LatencyHistogram {
+public:
+  static constexpr int SUB_BUCKET_BITS = 3;
+  static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static constexpr int MAX_VALUE_BITS = 40;
+  static constexpr int BUCKET_COUNT =
+      (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  // 单调时钟纳秒数（用于计算时间差）
+  static qint64 nowNs();
+
+  // 记录一个样本（纳秒，线程安全）
+  void record(qint64 valueNs);
+
+  // 拷贝当前计数（线程安全，计数之间不保证是同一时刻）
+  LatencyHistogramSnapshot snapshot() const;
+
+  // 值所在的桶
+  static int bucketIndex(quint64 value);
+
+  // 桶的上界（包含）
+  static quint64 bucketUpperBound(int index);
+
+private:
+  std::array<std::atomic<quint64>, BUCKET_COUNT> m_counts{};
+};
+
+/**
+ * @brief 每个 I/O Worker 的运行时计数器
+ *
+ * 由 Worker 所在线程中的 ClientHandler 更新，其他线程（如主线程的负载均衡和
+ * 统计快照）只读取。所有计数器都使用 relaxed 原子操作，热路径上没有锁。
+ */
+struct WorkerCounters {
+  std::atomic<quint64> bytesIn{0};          // 接收字节数
+  std::atomic<quint64> bytesOut{0};         // 发送字节数（已写入内核）
+  std::atomic<quint64> messagesIn{0};       // 接收消息数
+  std::atomic<quint64> messagesOut{0};      // 发送消息数（进入发送路径）
+  std::atomic<quint64> messagesHandled{0};  // 在 I/O 线程中处理的消息数
+  std::atomic<quint64> accepts{0};          // 接受的连接数
+  std::atomic<quint64> disconnects{0};      // 断开的连接数
+  std::atomic<quint64> parseErrors{0};      // 帧解析错误数
+  std::atomic<quint64> droppedMessages{0};  // 因发送队列超限丢弃的消息数
+  std::atomic<quint64> idleTimeouts{0};     // 因空闲超时断开的连接数
+  std::atomic<quint64> heartbeatTimeouts{0}; // 因心跳未应答断开的连接数
+  std::atomic<quint64> handlersReused{0};   // 从对象池复用的处理器数
+  std::atomic<quint64> compressedOut{0};    // 压缩发送的数据帧数
+  std::atomic<quint64> compressionSavedBytes{0}; // 压缩节省的字节数
+  std::atomic<int> pooledHandlers{0};       // 对象池中的空闲处理器数
+  std::atomic<qint64> pendingSendBytes{0};  // 所有连接的待发送字节数
+  std::atomic<qint64> rttSumNs{0};          // 所有连接平滑 RTT 之和
+  std::atomic<qint64> rttClients{0};        // 已测得 RTT 的连接数
+  LatencyHistogram dispatchLatency;         // 读取到投递的耗时
+  LatencyHistogram rtt;                     // 心跳 RTT 样本分布
+
+  // 本线程连接的平均 RTT（纳秒），没有样本时为 0
+  qint64 averageRttNs() const {
+    const qint64 clients = rttClients.load(std::memory_order_relaxed);
+    return clients > 0 ? rttSumNs.load(std::memory_order_relaxed) / clients
+                       : 0;
+  }
+
+  // 收发总字节数
+  quint64 totalBytes() const {
+    return bytesIn.load(std::memory_order_relaxed) +
+           bytesOut.load(std::memory_order_relaxed);
+  }
+};
+
+/**
+ * @brief 单个 Worker 的统计快照
+ */
+struct WorkerStats {
+  int workerIndex = -1;         // Worker 索引，汇总值为 -1
+  int clientCount = 0;          // 当前连接数
+  quint64 bytesIn = 0;          // 接收字节数
+  quint64 bytesOut = 0;         // 发送字节数
+  quint64 messagesIn = 0;       // 接收消息数
+  quint64 messagesOut = 0;      // 发送消息数
+  quint64 messagesHandled = 0;  // 在 I/O 线程中处理的消息数
+  quint64 accepts = 0;          // 接受的连接数
+  quint64 disconnects = 0;      // 断开的连接数
+  quint64 parseErrors = 0;      // 帧解析错误数
+  quint64 droppedMessages = 0;  // 丢弃的消息数
+  quint64 idleTimeouts = 0;     // 空闲超时断开的连接数
+  quint64 heartbeatTimeouts = 0; // 心跳未应答断开的连接数
+  quint64 handlersReused = 0;   // 从对象池复用的处理器数
+  quint64 compressedOut = 0;    // 压缩发送的数据帧数
+  quint64 compressionSavedBytes = 0; // 压缩节省的字节数
+  int pooledHandlers = 0;       // 对象池中的空闲处理器数
+  qint64 pendingSendBytes = 0;  // 待发送字节数
+  qint64 rttSumNs = 0;          // 各连接平滑 RTT 之和
+  qint64 rttClients = 0;        // 已测得 RTT 的连接数
+  LatencyHistogramSnapshot dispatchLatency; // 读取到投递的耗时分布
+  LatencyHistogramSnapshot rtt;             // 心跳 RTT 样本分布
+  BufferPoolStats bufferPool;               // 接收缓冲池占用
+
+  // 各连接平滑 RTT 的平均值（纳秒），没有样本时为 0
+  qint64 averageRttNs() const {
+    return rttClients > 0 ? rttSumNs / rttClients : 0;
+  }
+
+  // 从计数器生成快照
+  static WorkerStats fromCounters(int workerIndex, int clientCount,
+                                  const WorkerCounters &counters);
+
+  // 累加另一个 Worker 的统计
+  void add(const WorkerStats &other);
+};
+
+/**
+ * @brief 服务器统计快照
+ *
+ * 由 TCPServer::stats() 生成，只读取各 Worker 的原子计数器，不打扰 I/O 线程。
+ */
+struct ServerStats {
+  QList<WorkerStats> workers; // 每个 Worker 的统计
+  AdmissionStats admission;   // 连接准入统计（全服务器共用）
+
+  // 所有 Worker 的汇总
+  WorkerStats total() const;
+};
+
+Q_DECLARE_METATYPE(WorkerStats)
+Q_DECLARE_METATYPE(ServerStats)
+
+#endif // SERVERSTATS_H
@@ -0,0 +1,93 @@
+#ifndef SERVERTYPES_H
+#define SERVERTYPES_H
+
+#include "ClientHandle.h"
+#include <QByteArray>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief TCP 服务器公共类型定义
+ *
+ * 在 TCPServer、IOThreadPool、IOThreadWorker 之间共享的数据结构和配置项。
+ */
+
+// 新连接分配到 I/O 线程的策略
+enum class PlacementStrategy {
+  RoundRobin,        // 轮询
+  LeastConnections,  // 连接数最少的线程
+  LeastLoad,         // 收发字节速率最低的线程
+  PowerOfTwoChoices  // 随机选两个线程，取连接数较少者
+};
+
+// 一条接收到的消息（批量投递时使用）
+struct ReceivedMessage {
+  ClientId clientId = ClientHandle::Invalid; // 客户端句柄
+  QByteArray data;                           // 原始二进制负载
+};
+
+using ReceivedMessageList = QList<ReceivedMessage>;
+
+// 批量投递配置：把 Worker 在一次事件循环迭代内解码的消息合并成一个信号
+struct BatchDeliveryOptions {
+  bool enabled = false;    // 是否启用批量投递
+  int maxBatchSize = 256;  // 批次达到该条数时立即发出
+  int flushIntervalMs = 0; // 最长等待时间，0 表示当前事件循环迭代结束后发出
+};
+
+// 发送队列超过高水位时的处理策略
+enum class OverflowPolicy {
+  DropNewest, // 丢弃新消息
+  DropOldest, // 丢弃队列中最旧的、尚未交给 socket 的消息
+  Disconnect  // 断开慢速客户端
+};
+
+// 每个连接的发送队列水位配置
+// 待发送字节数 = QTcpSocket::bytesToWrite() + 尚未交给 socket 的排队字节数
+struct SendQueueLimits {
+  qint64 highWaterMark = 0; // 高水位（字节），0 表示不限制
+  qint64 lowWaterMark = 0;  // 低水位（字节），0 表示取高水位的一半
+  OverflowPolicy policy = OverflowPolicy::DropNewest; // 超限策略
+};
+
+// 每个 Worker 的 ClientHandler 对象池配置：断开的处理器（连同 socket、
+// 信号连接和接收缓冲区容量）放回池中复用，应对大量客户端同时重连
+struct HandlerPoolOptions {
+  int warmSize = 0; // 预先创建的处理器数
+  int maxSize = 0;  // 池中最多保留的空闲处理器数，0 表示不复用
+};
+
+// I/O 线程的 CPU 绑定方式
+enum class CpuAffinityMode {
+  None,     // 不绑定，由操作系统调度
+  Explicit, // 按 cpus 列表绑定
+  Topology  // 按 /sys 中的 NUMA/核心拓扑选择，优先每个物理核心一个线程
+};
+
+// I/O 线程的 CPU 亲和性和命名策略（在线程池启动时生效）
+// 预留 CPU 从候选列表（Explicit 为 cpus，Topology 为拓扑顺序）头部取出，
+// I/O 线程只使用剩余的 CPU
+struct ThreadPolicy {
+  CpuAffinityMode affinity = CpuAffinityMode::None; // 绑定方式
+  QList<int> cpus;            // Explicit：第 i 个 I/O 线程绑定剩余列表的第 i 个
+  int reservedCpus = 0;       // 预留给主线程（accept）的 CPU 数
+  bool pinMainThread = false; // 是否把启动服务器的线程绑定到预留 CPU
+  QString threadNamePrefix = QStringLiteral("IOThread"); // 线程名：前缀-索引
+};
+
+// 优雅关闭（drain）的结果
+struct DrainResult {
+  bool completed = false;  // 截止前所有发送队列都已清空
+  int clients = 0;         // 开始 drain 时的连接数
+  qint64 flushedBytes = 0; // 开始时积压的数据中已写出的字节数（含 Goodbye 帧）
+  qint64 droppedBytes = 0; // 截止时仍未发送、随连接关闭丢弃的字节数
+};
+
+Q_DECLARE_METATYPE(ReceivedMessage)
+Q_DECLARE_METATYPE(BatchDeliveryOptions)
+Q_DECLARE_METATYPE(SendQueueLimits)
+Q_DECLARE_METATYPE(HandlerPoolOptions)
+
+#endif // SERVERTYPES_H
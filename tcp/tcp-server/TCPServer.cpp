@@ -1,30 +1,48 @@
 #include "TCPServer.h"
 #include "IOThreadPool.h"
+#include "NetLog.h"
+#include "ReusePortAcceptor.h"
 #include <QDebug>
 #include <QHostAddress>
+#include <QMetaMethod>
 
 TCPServer::TCPServer(int threadCount, QObject *parent)
-    : QTcpServer(parent), m_threadPool(new IOThreadPool(threadCount, this)) {
-  // 连接线程池信号（队列连接，跨线程通信）
+    : TCPServer(threadCount, PlacementStrategy::RoundRobin, parent) {}
+
+TCPServer::TCPServer(int threadCount, PlacementStrategy strategy,
+                     QObject *parent)
+    : QTcpServer(parent),
+      m_threadPool(new IOThreadPool(threadCount, strategy, this)),
+      m_reusePortPort(0), m_reusePortEnabled(false) {
+  // 连接线程池信号：线程池是本对象的子对象，始终与服务器同在一个线程，
+  // 跨线程的排队已在 Worker -> 线程池之间完成，这里直接连接，避免二次入队
   connect(m_threadPool, &IOThreadPool::clientReady, this,
-          &TCPServer::clientConnected, Qt::QueuedConnection);
-  connect(m_threadPool, &IOThreadPool::messageReceived, this,
-          &TCPServer::messageReceived, Qt::QueuedConnection);
+          &TCPServer::clientConnected, Qt::DirectConnection);
+  connect(m_threadPool, &IOThreadPool::dataReceived, this,
+          &TCPServer::dispatchData, Qt::DirectConnection);
+  connect(m_threadPool, &IOThreadPool::messagesReceived, this,
+          &TCPServer::dispatchBatch, Qt::DirectConnection);
+  connect(m_threadPool, &IOThreadPool::messageChunk, this,
+          &TCPServer::messageChunk, Qt::DirectConnection);
   connect(m_threadPool, &IOThreadPool::clientDisconnected, this,
-          &TCPServer::clientDisconnected, Qt::QueuedConnection);
+          &TCPServer::clientDisconnected, Qt::DirectConnection);
+  connect(m_threadPool, &IOThreadPool::sendQueueHigh, this,
+          &TCPServer::sendQueueHigh, Qt::DirectConnection);
+  connect(m_threadPool, &IOThreadPool::sendQueueDrained, this,
+          &TCPServer::sendQueueDrained, Qt::DirectConnection);
   connect(
       m_threadPool, &IOThreadPool::errorOccurred, this,
-      [this](qintptr clientId, const QString &error) {
+      [this](ClientId clientId, const QString &error) {
         Q_UNUSED(clientId)
         emit errorOccurred(error);
       },
-      Qt::QueuedConnection);
+      Qt::DirectConnection);
 }
 
 TCPServer::~TCPServer() { stopServer(); }
 
 bool TCPServer::startServer(quint16 port) {
-  if (isListening()) {
+  if (isRunning()) {
     emit errorOccurred("服务器已经在运行");
     return false;
   }
@@ -32,28 +50,55 @@ bool TCPServer::startServer(quint16 port) {
   // 启动线程池
   m_threadPool->start();
 
-  // 监听端口
-  if (!listen(QHostAddress::Any, port)) {
+  // 监听端口：SO_REUSEPORT 模式下每个 I/O 线程各自监听同一端口，由内核分发连接
+  if (m_reusePortEnabled) {
+    m_reusePortPort = m_threadPool->startReusePortListeners(port);
+    if (m_reusePortPort == 0) {
+      emit errorOccurred("启动服务器失败: SO_REUSEPORT 监听失败");
+      m_threadPool->stop();
+      return false;
+    }
+  } else if (!listen(QHostAddress::Any, port)) {
     emit errorOccurred(QString("启动服务器失败: %1").arg(errorString()));
     m_threadPool->stop();
     return false;
   }
 
-  qDebug() << "[TCPServer] 启动成功，监听端口:" << port
-           << "，线程池大小:" << m_threadPool->threadCount();
-  emit serverStarted(port);
+  qDebug() << "[TCPServer] 启动成功，监听端口:" << listeningPort()
+           << "，线程池大小:" << m_threadPool->threadCount()
+           << (m_reusePortEnabled ? "，SO_REUSEPORT 模式" : "");
+  emit serverStarted(listeningPort());
   return true;
 }
 
+DrainResult TCPServer::drain(int timeoutMs) {
+  if (!isRunning()) {
+    return DrainResult();
+  }
+
+  qDebug() << "[TCPServer] drain 中...";
+
+  // 先停止接受新连接（SO_REUSEPORT 监听 socket 由各 Worker 在 drain 开始时关闭）
+  close();
+  m_reusePortPort = 0;
+
+  const DrainResult result = m_threadPool->drain(qMax(0, timeoutMs));
+
+  emit serverStopped();
+  qDebug() << "[TCPServer] 已停止，drain" << (result.completed ? "完成" : "超时");
+  return result;
+}
+
 void TCPServer::stopServer() {
-  if (!isListening()) {
+  if (!isRunning()) {
     return;
   }
 
   qDebug() << "[TCPServer] 停止中...";
 
-  // 关闭服务器
+  // 关闭服务器（SO_REUSEPORT 监听 socket 由各 Worker 在清理时关闭）
   close();
+  m_reusePortPort = 0;
 
   // 停止线程池（会断开所有客户端）
   m_threadPool->stop();
@@ -62,23 +107,169 @@ void TCPServer::stopServer() {
   qDebug() << "[TCPServer] 已停止";
 }
 
-void TCPServer::sendMessage(qintptr clientId, const QString &message) {
-  m_threadPool->sendMessage(clientId, message);
+bool TCPServer::isRunning() const {
+  return isListening() || m_reusePortPort != 0;
+}
+
+quint16 TCPServer::listeningPort() const {
+  return m_reusePortPort != 0 ? m_reusePortPort : serverPort();
+}
+
+void TCPServer::setReusePortEnabled(bool enabled) {
+  if (isRunning()) {
+    emit errorOccurred("服务器运行中，无法切换监听模式");
+    return;
+  }
+  if (enabled && !isReusePortSupported()) {
+    emit errorOccurred("当前平台不支持 SO_REUSEPORT 监听模式");
+    return;
+  }
+  m_reusePortEnabled = enabled;
+}
+
+bool TCPServer::isReusePortSupported() {
+  return ReusePortAcceptor::isSupported();
+}
+
+void TCPServer::setThreadPolicy(const ThreadPolicy &policy) {
+  if (isRunning()) {
+    emit errorOccurred("服务器运行中，无法修改线程策略");
+    return;
+  }
+  m_threadPool->setThreadPolicy(policy);
+}
+
+void TCPServer::sendData(ClientId clientId, const QByteArray &data) {
+  m_threadPool->sendData(clientId, data);
+}
+
+void TCPServer::broadcastData(const QByteArray &data) {
+  m_threadPool->broadcastData(data);
+  NET_DEBUG(lcNetIo) << "[TCPServer] 广播数据给所有客户端 (字节数:"
+                     << data.size() << ")";
+}
+
+void TCPServer::sendMessage(ClientId clientId, const QString &message) {
+  sendData(clientId, message.toUtf8());
 }
 
 void TCPServer::broadcastMessage(const QString &message) {
-  m_threadPool->broadcastMessage(message);
-  qDebug() << "[TCPServer] 广播消息给所有客户端:" << message;
+  broadcastData(message.toUtf8());
+}
+
+void TCPServer::subscribe(ClientId clientId, const QString &topic) {
+  m_threadPool->subscribe(clientId, topic);
+}
+
+void TCPServer::unsubscribe(ClientId clientId, const QString &topic) {
+  m_threadPool->unsubscribe(clientId, topic);
+}
+
+void TCPServer::publish(const QString &topic, const QByteArray &data) {
+  m_threadPool->publish(topic, data);
+  NET_DEBUG(lcNetIo) << "[TCPServer] 发布主题" << topic << "(字节数:"
+                     << data.size() << ")";
+}
+
+void TCPServer::publishMessage(const QString &topic, const QString &message) {
+  publish(topic, message.toUtf8());
+}
+
+void TCPServer::sendChunk(ClientId clientId, quint32 streamId,
+                          const QByteArray &data, bool last) {
+  m_threadPool->sendChunk(clientId, streamId, data, last);
+}
+
+void TCPServer::setBatchDelivery(const BatchDeliveryOptions &options) {
+  m_threadPool->setBatchDelivery(options);
+}
+
+void TCPServer::setWriteCoalescing(const WriteCoalescingOptions &options) {
+  m_threadPool->setWriteCoalescing(options);
+}
+
+void TCPServer::setSendQueueLimits(const SendQueueLimits &limits) {
+  m_threadPool->setSendQueueLimits(limits);
+}
+
+void TCPServer::setIdleTimeout(int timeoutMs) {
+  m_threadPool->setIdleTimeout(timeoutMs);
+}
+
+int TCPServer::idleTimeout() const { return m_threadPool->idleTimeout(); }
+
+void TCPServer::setReceiveBufferCacheLimit(qint64 bytes) {
+  m_threadPool->setReceiveBufferCacheLimit(bytes);
+}
+
+void TCPServer::setHandlerPool(const HandlerPoolOptions &options) {
+  m_threadPool->setHandlerPool(options);
+}
+
+void TCPServer::setCompression(const CompressionOptions &options) {
+  m_threadPool->setCompression(options);
+}
+
+void TCPServer::setStreamingReceive(bool enabled) {
+  m_threadPool->setStreamingReceive(enabled);
+}
+
+void TCPServer::setAdmissionControl(const AdmissionOptions &options) {
+  m_threadPool->setAdmissionControl(options);
+}
+
+void TCPServer::setMessageHandler(const MessageHandlerPtr &handler) {
+  m_threadPool->setMessageHandler(handler);
+}
+
+void TCPServer::setHeartbeat(const HeartbeatOptions &options) {
+  m_threadPool->setHeartbeat(options);
 }
 
 int TCPServer::clientCount() const { return m_threadPool->totalClientCount(); }
 
 int TCPServer::threadPoolSize() const { return m_threadPool->threadCount(); }
 
+PlacementStrategy TCPServer::placementStrategy() const {
+  return m_threadPool->placementStrategy();
+}
+
+ServerStats TCPServer::stats() const { return m_threadPool->statsSnapshot(); }
+
 void TCPServer::incomingConnection(qintptr socketDescriptor) {
   // 主 Reactor：直接获取 socket 描述符并分配给从 Reactor
-  qDebug() << "[TCPServer] 接受新连接，socket 描述符:" << socketDescriptor;
+  NET_DEBUG(lcNetIo) << "[TCPServer] 接受新连接，socket 描述符:"
+                     << socketDescriptor;
 
-  // 将 socket 描述符分配给线程池（轮询策略）
+  // 将 socket 描述符分配给线程池（按分配策略）
   m_threadPool->addClient(socketDescriptor);
 }
+
+void TCPServer::dispatchData(ClientId clientId, const QByteArray &data) {
+  emit dataReceived(clientId, data);
+
+  // 字符串接口是二进制接口之上的薄封装：只有在有接收者时才做 UTF-8 解码
+  static const QMetaMethod messageReceivedSignal =
+      QMetaMethod::fromSignal(&TCPServer::messageReceived);
+  if (isSignalConnected(messageReceivedSignal)) {
+    emit messageReceived(clientId, QString::fromUtf8(data));
+  }
+}
+
+void TCPServer::dispatchBatch(const ReceivedMessageList &messages) {
+  emit messagesReceived(messages);
+
+  // 兼容逐条接收的调用方：只在有接收者时展开批次
+  static const QMetaMethod dataReceivedSignal =
+      QMetaMethod::fromSignal(&TCPServer::dataReceived);
+  static const QMetaMethod messageReceivedSignal =
+      QMetaMethod::fromSignal(&TCPServer::messageReceived);
+  if (!isSignalConnected(dataReceivedSignal) &&
+      !isSignalConnected(messageReceivedSignal)) {
+    return;
+  }
+
+  for (const ReceivedMessage &message : messages) {
+    dispatchData(message.clientId, message.data);
+  }
+}
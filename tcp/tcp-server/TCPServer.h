@@ -1,6 +1,14 @@
 #ifndef TCPSERVER_H
 #define TCPSERVER_H
 
+#include "AdmissionController.h"
+#include "FrameCompression.h"
+#include "Heartbeat.h"
+#include "MessageHandler.h"
+#include "ServerStats.h"
+#include "ServerTypes.h"
+#include "WriteCoalescer.h"
+#include <QByteArray>
 #include <QString>
 #include <QTcpServer>
 
@@ -12,23 +20,27 @@ class IOThreadPool;
  * 架构设计：
  * - 主 Reactor（Main Reactor）：TCPServer 运行在主线程
  *   - 负责监听端口和接受新连接
- *   - 使用轮询策略将新连接分配给从 Reactor
+ *   - 按可选的分配策略（默认轮询）将新连接分配给从 Reactor
  * - 从 Reactor（Sub Reactor）：I/O 线程池
  *   - 每个线程处理部分客户端的 I/O 操作
  *   - 每个线程有独立的事件循环
  *   - 在 I/O 线程中处理业务逻辑
+ * - 可选 SO_REUSEPORT 模式（仅 Linux）：每个 I/O 线程持有自己的监听
+ *   socket，由内核分发新连接，主线程不再参与 accept，对外信号保持不变
  *
  * 功能特性：
  * - 支持高并发多客户端连接
  * - 自动处理 TCP 黏包和半包问题
- * - 消息格式：[4字节长度(大端)][UTF-8消息内容]
+ * - 消息格式：v1 为 [4字节长度(大端)][消息内容]，客户端发起 Hello 时可协商 v2（见 FrameCodec）
+ * - 提供二进制接口（sendData/dataReceived），字符串接口只是其上的 UTF-8 封装
  * - 使用网络字节序（大端）保证跨平台兼容性
- * - 线程池大小可配置，默认基于 CPU 核心数
+ * - 线程池大小可配置，默认基于本进程可用的 CPU 数
+ * - 客户端以带代数的 64 位句柄（ClientId）标识，过期句柄不会误伤新连接
  *
  * 线程安全：
  * - 此类是线程安全的
  * - 使用信号槽机制实现跨线程通信
- * - 所有信号都使用队列连接
+ * - Worker 到线程池使用队列连接，线程池到服务器在同一线程内直接连接
  */
 class TCPServer : public QTcpServer {
   Q_OBJECT
@@ -36,31 +48,150 @@ class TCPServer : public QTcpServer {
 public:
   /**
    * @brief 构造函数
-   * @param threadCount I/O 线程池大小，0 表示使用 CPU 核心数
+   * @param threadCount I/O 线程池大小，0 表示使用本进程可用的 CPU 数
    * @param parent 父对象
    */
   explicit TCPServer(int threadCount = 0, QObject *parent = nullptr);
 
+  /**
+   * @brief 构造函数
+   * @param threadCount I/O 线程池大小，0 表示使用本进程可用的 CPU 数
+   * @param strategy 新连接分配到 I/O 线程的策略
+   * @param parent 父对象
+   */
+  TCPServer(int threadCount, PlacementStrategy strategy,
+            QObject *parent = nullptr);
+
   ~TCPServer() override;
 
   // 启动服务器
   bool startServer(quint16 port);
 
-  // 停止服务器
+  // 停止服务器（立即关闭所有连接，未发送的数据被丢弃）
   void stopServer();
 
-  // 发送消息给指定客户端（线程安全）
-  void sendMessage(qintptr clientId, const QString &message);
+  // 优雅关闭服务器：停止接受新连接，向协商过版本的客户端发送 Goodbye，
+  // 继续写出发送队列直到清空或超过 timeoutMs，然后关闭所有连接。
+  // 等待期间调用线程运行局部事件循环（已排队的信号照常投递），
+  // 返回写出和丢弃的字节数
+  DrainResult drain(int timeoutMs);
+
+  // 服务器是否正在运行（两种监听模式下均有效）
+  bool isRunning() const;
+
+  // 实际监听端口（startServer 传入 0 时为系统分配的端口），未运行时返回 0
+  quint16 listeningPort() const;
+
+  // 启用 SO_REUSEPORT 多监听模式，需在 startServer 之前设置
+  void setReusePortEnabled(bool enabled);
+
+  // 是否启用了 SO_REUSEPORT 多监听模式
+  bool isReusePortEnabled() const { return m_reusePortEnabled; }
+
+  // 当前平台是否支持 SO_REUSEPORT 多监听模式
+  static bool isReusePortSupported();
 
-  // 广播消息给所有客户端（线程安全）
+  // 设置 I/O 线程的 CPU 亲和性和命名策略（仅 Linux 支持绑定），
+  // 需在 startServer 之前设置
+  void setThreadPolicy(const ThreadPolicy &policy);
+
+  // 发送二进制数据给指定客户端（线程安全）
+  void sendData(ClientId clientId, const QByteArray &data);
+
+  // 广播二进制数据给所有客户端（线程安全）
+  void broadcastData(const QByteArray &data);
+
+  // 发送消息给指定客户端（线程安全，UTF-8 编码后发送）
+  void sendMessage(ClientId clientId, const QString &message);
+
+  // 广播消息给所有客户端（线程安全，UTF-8 编码后发送）
   void broadcastMessage(const QString &message);
 
+  // 客户端订阅主题（线程安全）。订阅关系保存在客户端所在的 I/O 线程中，
+  // 客户端断开时自动取消
+  void subscribe(ClientId clientId, const QString &topic);
+
+  // 客户端取消订阅主题（线程安全）
+  void unsubscribe(ClientId clientId, const QString &topic);
+
+  // 发布二进制数据给订阅了主题的客户端（线程安全）。每个 I/O 线程只收到
+  // 一个事件，由线程内的主题索引扇出，不再逐个客户端跨线程发送
+  void publish(const QString &topic, const QByteArray &data);
+
+  // 发布消息给订阅了主题的客户端（线程安全，UTF-8 编码后发送）
+  void publishMessage(const QString &topic, const QString &message);
+
+  // 发送分块消息的一块给指定客户端（线程安全）。同一条消息的各块使用同一个
+  // streamId 依次发送，最后一块 last 为 true；消息总长度不受 10MB 限制。
+  // 客户端须协商出 v2（见 TCPClient::setProtocolVersion），否则报错并丢弃
+  void sendChunk(ClientId clientId, quint32 streamId, const QByteArray &data,
+                 bool last);
+
+  // 设置批量投递：Worker 把一次事件循环迭代内解码的消息合并为一个
+  // messagesReceived 信号，减少主线程的跨线程事件数量（可在运行时修改）
+  void setBatchDelivery(const BatchDeliveryOptions &options);
+
+  // 设置写合并：同一事件循环迭代内发往同一客户端的帧合并为一次写入，
+  // 达到字节阈值或等待时间后写出（可在运行时修改）
+  void setWriteCoalescing(const WriteCoalescingOptions &options);
+
+  // 设置每个连接的发送队列高/低水位和超限策略，防止慢速客户端
+  // 让服务器内存无限增长（广播同样生效，可在运行时修改）
+  void setSendQueueLimits(const SendQueueLimits &limits);
+
+  // 设置空闲超时：连接在该时间内没有任何读写活动即被断开，
+  // 0 表示不检测（默认，可在运行时修改）
+  void setIdleTimeout(int timeoutMs);
+
+  // 获取空闲超时（毫秒）
+  int idleTimeout() const;
+
+  // 设置每个 I/O 线程接收缓冲池保留的空闲缓冲区总容量（字节，默认 16MB）。
+  // 连接只在组装半包时借用接收缓冲区，空闲连接不占用（可在运行时修改）
+  void setReceiveBufferCacheLimit(qint64 bytes);
+
+  // 设置每个 I/O 线程的连接处理器对象池：断开的处理器连同 socket 放回池中，
+  // 大量客户端同时重连时不再逐个分配和初始化 QObject（可在运行时修改）
+  void setHandlerPool(const HandlerPoolOptions &options);
+
+  // 设置心跳：每个 I/O 线程按间隔向所有连接发送 Ping，测量 RTT（见 stats()），
+  // 连续 maxMissed 个 Ping 未应答且期间没有收到任何数据时断开连接。
+  // 对端必须支持控制帧（本项目的 TCPClient），默认关闭（可在运行时修改）
+  void setHeartbeat(const HeartbeatOptions &options);
+
+  // 设置数据帧压缩：内容达到阈值时压缩后发送，只对协商出 v2 且声明支持压缩的
+  // 连接生效，其余连接照常发送原始内容。广播只压缩一次，所有连接共享压缩结果。
+  // 默认关闭（可在运行时修改）
+  void setCompression(const CompressionOptions &options);
+
+  // 设置是否流式接收客户端发来的分块消息：开启时每块到达后立即发出
+  // messageChunk，不缓存整条消息；关闭时（默认）拼接为完整消息后发出
+  // dataReceived（可在运行时修改，只影响之后开始的流）
+  void setStreamingReceive(bool enabled);
+
+  // 设置连接准入控制：全局连接数上限、单个来源地址的连接数上限和接受速率
+  // （令牌桶）。被拒绝的连接在创建 socket 之前直接关闭，计入 stats().admission
+  // （可在运行时修改，已建立的连接不受影响）
+  void setAdmissionControl(const AdmissionOptions &options);
+
+  // 注册在 I/O 线程中处理消息的处理器（线程安全，可在运行时替换，传空表示
+  // 取消）。处理器在解码消息的 I/O 线程中被调用并可就地回复，返回 true 的消息
+  // 不再发出 dataReceived/messageReceived；对象被所有 I/O 线程共享，必须线程安全
+  void setMessageHandler(const MessageHandlerPtr &handler);
+
   // 获取当前连接数
   int clientCount() const;
 
   // 获取线程池大小
   int threadPoolSize() const;
 
+  // 获取连接分配策略
+  PlacementStrategy placementStrategy() const;
+
+  // 获取统计快照：每个 I/O 线程的收发字节数和消息数、连接数、解析错误、
+  // 待发送字节数、读取到投递的延迟分布和心跳 RTT（热路径上没有额外开销）
+  ServerStats stats() const;
+
 signals:
   // 服务器启动成功
   void serverStarted(quint16 port);
@@ -69,13 +200,31 @@ signals:
   void serverStopped();
 
   // 新客户端连接
-  void clientConnected(qintptr clientId, const QString &address);
+  void clientConnected(ClientId clientId, const QString &address);
 
   // 客户端断开
-  void clientDisconnected(qintptr clientId);
+  void clientDisconnected(ClientId clientId);
+
+  // 客户端发送队列超过高水位
+  void sendQueueHigh(ClientId clientId, qint64 pendingBytes);
+
+  // 客户端发送队列回落到低水位以下
+  void sendQueueDrained(ClientId clientId);
 
-  // 接收到消息
-  void messageReceived(qintptr clientId, const QString &message);
+  // 接收到二进制数据
+  void dataReceived(ClientId clientId, const QByteArray &data);
+
+  // 接收到消息（UTF-8 解码，仅在有接收者连接时才解码）
+  void messageReceived(ClientId clientId, const QString &message);
+
+  // 批量接收到的消息（启用批量投递时发出，随后仍会逐条发出
+  // dataReceived/messageReceived 以兼容现有接收者）
+  void messagesReceived(const ReceivedMessageList &messages);
+
+  // 流式接收模式下收到分块消息的一块（同一个流按顺序发出，offset 为
+  // 本块在消息中的偏移，last 表示消息结束）
+  void messageChunk(ClientId clientId, quint32 streamId, qint64 offset,
+                    const QByteArray &data, bool last);
 
   // 错误信息
   void errorOccurred(const QString &error);
@@ -85,7 +234,15 @@ protected:
   void incomingConnection(qintptr socketDescriptor) override;
 
 private:
+  // 分发接收到的数据（按需解码为字符串）
+  void dispatchData(ClientId clientId, const QByteArray &data);
+
+  // 分发一批接收到的消息
+  void dispatchBatch(const ReceivedMessageList &messages);
+
   IOThreadPool *m_threadPool; // I/O 线程池（从 Reactor）
+  quint16 m_reusePortPort;    // SO_REUSEPORT 模式下的监听端口（0 表示未监听）
+  bool m_reusePortEnabled;    // 是否启用 SO_REUSEPORT 多监听模式
 };
 
 #endif // TCPSERVER_H
@@ -0,0 +1,28 @@
+#include "TimingWheel.h"
+#include <utility>
+
+TimingWheel::TimingWheel(int slotCount) : m_slots(qMax(1, slotCount)) {}
+
+void TimingWheel::schedule(ClientId clientId, quint64 deadlineTick) {
+  if (deadlineTick <= m_currentTick) {
+    deadlineTick = m_currentTick + 1;
+  }
+  m_slots[static_cast<qsizetype>(deadlineTick % m_slots.size())].append(
+      clientId);
+  ++m_size;
+}
+
+QList<ClientId> TimingWheel::advance() {
+  ++m_currentTick;
+  QList<ClientId> &slot =
+      m_slots[static_cast<qsizetype>(m_currentTick % m_slots.size())];
+  m_size -= slot.size();
+  return std::exchange(slot, {});
+}
+
+void TimingWheel::clear() {
+  for (QList<ClientId> &slot : m_slots) {
+    slot.clear();
+  }
+  m_size = 0;
+}
@@ -0,0 +1,48 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include "ClientHandle.h"
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * @brief 哈希时间轮，用于空闲连接超时检测
+ *
+ * 设计目的：
+ * - 每个 Worker 只用一个 QTimer 驱动，不为每个连接创建定时器
+ * - 连接有读写活动时只更新自己的最后活动刻度（O(1)，不触碰时间轮）
+ * - 到期桶中的条目由调用方惰性检查：仍然活跃的连接按新的截止刻度重新入轮，
+ *   已空闲的连接被断开，句柄已过期（连接已断开）的条目直接丢弃
+ *
+ * 每个连接在时间轮中只有一个条目，内存占用与连接数成正比。
+ * 截止刻度超过一圈时落入同一个哈希桶，提前弹出后由调用方重新入轮。
+ *
+ * 线程安全：
+ * - 此类不是线程安全的，只能在所属 Worker 的线程中使用
+ */
+class TimingWheel {
+public:
+  explicit TimingWheel(int slotCount = 256);
+
+  // 当前刻度（单调递增）
+  quint64 currentTick() const { return m_currentTick; }
+
+  // 在 deadlineTick 到期时弹出该客户端（已过期的截止刻度按下一个刻度处理）
+  void schedule(ClientId clientId, quint64 deadlineTick);
+
+  // 推进一个刻度，返回新刻度所在桶中的全部条目
+  QList<ClientId> advance();
+
+  // 清空所有条目（刻度继续保持单调）
+  void clear();
+
+  // 时间轮中的条目数
+  qsizetype size() const { return m_size; }
+
+private:
+  QList<QList<ClientId>> m_slots; // 哈希桶
+  quint64 m_currentTick = 0;      // 当前刻度
+  qsizetype m_size = 0;           // 条目数
+};
+
+#endif // TIMINGWHEEL_H
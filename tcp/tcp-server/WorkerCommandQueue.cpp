@@ -0,0 +1,56 @@
+#include "WorkerCommandQueue.h"
+
+WorkerCommandQueue::WorkerCommandQueue() : m_head(&m_stub), m_tail(&m_stub) {}
+
+WorkerCommandQueue::~WorkerCommandQueue() {
+  while (WorkerCommand *command = pop()) {
+    delete command;
+  }
+}
+
+bool WorkerCommandQueue::push(WorkerCommand *command) {
+  link(command);
+  return requestWakeup();
+}
+
+void WorkerCommandQueue::link(WorkerCommand *command) {
+  // 先交换头指针占位，再把前一个节点指向自己；两步之间消费者会看到
+  // 链表暂时断开，此时 pop 返回 nullptr，本节点由随后的唤醒处理
+  command->next.store(nullptr, std::memory_order_relaxed);
+  WorkerCommand *prev = m_head.exchange(command, std::memory_order_acq_rel);
+  prev->next.store(command, std::memory_order_release);
+}
+
+WorkerCommand *WorkerCommandQueue::pop() {
+  WorkerCommand *tail = m_tail;
+  WorkerCommand *next = tail->next.load(std::memory_order_acquire);
+
+  // 跳过哨兵节点
+  if (tail == &m_stub) {
+    if (!next) {
+      return nullptr;
+    }
+    m_tail = next;
+    tail = next;
+    next = next->next.load(std::memory_order_acquire);
+  }
+
+  if (next) {
+    m_tail = next;
+    return tail;
+  }
+
+  // tail 不是最后入队的节点：生产者正在链接，稍后再取
+  if (tail != m_head.load(std::memory_order_acquire)) {
+    return nullptr;
+  }
+
+  // tail 是唯一的节点：重新放入哨兵，使 tail 可以安全出队
+  link(&m_stub);
+  next = tail->next.load(std::memory_order_acquire);
+  if (next) {
+    m_tail = next;
+    return tail;
+  }
+  return nullptr;
+}
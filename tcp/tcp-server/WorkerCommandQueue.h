@@ -0,0 +1,85 @@
+#ifndef WORKERCOMMANDQUEUE_H
+#define WORKERCOMMANDQUEUE_H
+
+#include "ClientHandle.h"
+#include "FrameCodec.h"
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 提交给 I/O Worker 的一条命令
+ *
+ * 由提交线程创建，入队后归队列所有，Worker 执行完毕后删除。
+ * 只使用与类型相关的字段，其余保持默认值。
+ */
+struct WorkerCommand {
+  enum class Type : quint8 {
+    SendData,       // 发送数据给 clientId（data）
+    SendChunk,      // 发送分块消息的一块（streamId、data、last）
+    BroadcastFrame, // 广播帧给本线程所有客户端（frame）
+    PublishFrame,   // 发布帧给本线程订阅了主题的客户端（topic、frame）
+    Subscribe,      // clientId 订阅 topic
+    Unsubscribe,    // clientId 取消订阅 topic
+    Disconnect,     // 断开 clientId
+  };
+
+  Type type = Type::SendData;
+  bool last = false;                         // 是否为分块消息的最后一块
+  quint32 streamId = 0;                      // 分块消息的流 ID
+  ClientId clientId = ClientHandle::Invalid; // 目标客户端
+  QByteArray data;                           // 单播负载
+  QString topic;                             // 主题
+  FrameCodec::PreparedFrame frame;           // 广播/发布的帧
+
+  std::atomic<WorkerCommand *> next{nullptr}; // 队列链接（由队列维护）
+};
+
+/**
+ * @brief 多生产者单消费者的无锁命令队列（侵入式链表）
+ *
+ * 设计目的：
+ * - 任意线程都可以入队，入队只有一次原子交换，不加锁，不分配事件对象
+ * - 队列从空闲变为非空时 push 返回 true，由提交方唤醒一次 Worker，
+ *   同一批命令只产生一次跨线程事件
+ * - 命令按入队顺序执行；同一提交线程的命令保持提交顺序
+ *
+ * 线程安全：
+ * - push 和 requestWakeup 可在任意线程调用
+ * - pop 和 beginDrain 只能在 Worker 线程中调用
+ */
+class WorkerCommandQueue {
+public:
+  WorkerCommandQueue();
+
+  ~WorkerCommandQueue();
+
+  WorkerCommandQueue(const WorkerCommandQueue &) = delete;
+  WorkerCommandQueue &operator=(const WorkerCommandQueue &) = delete;
+
+  // 入队（接管 command 的所有权），返回 true 表示需要唤醒消费者
+  bool push(WorkerCommand *command);
+
+  // 出队，队列为空（或生产者尚未完成链接）时返回 nullptr，调用方负责删除
+  WorkerCommand *pop();
+
+  // 开始处理一批命令：清除唤醒标志，之后入队的命令会再次唤醒
+  void beginDrain() { m_wakeupPending.store(false, std::memory_order_seq_cst); }
+
+  // 设置唤醒标志，返回 true 表示调用方需要唤醒消费者（之前没有待处理的唤醒）
+  bool requestWakeup() {
+    return !m_wakeupPending.exchange(true, std::memory_order_seq_cst);
+  }
+
+private:
+  // 把节点接到链表头部（生产者一侧）
+  void link(WorkerCommand *command);
+
+  std::atomic<WorkerCommand *> m_head; // 最后入队的节点（生产者一侧）
+  WorkerCommand *m_tail;               // 下一个出队的节点（消费者一侧）
+  WorkerCommand m_stub;                // 哨兵节点，队列为空时保持链表非空
+  std::atomic<bool> m_wakeupPending{false}; // 是否已有待处理的唤醒
+};
+
+#endif // WORKERCOMMANDQUEUE_H
@@ -1,5 +1,6 @@
 #include "UDPClientServer.h"
 #include <QDebug>
+#include <QMetaMethod>
 
 // UDP数据报推荐最大大小（避免IP分片）
 constexpr qint64 MAX_UDP_DATAGRAM_SIZE = 1472;
@@ -42,11 +43,8 @@ void UDPClientServer::unbind() {
   }
 }
 
-void UDPClientServer::sendMessage(const QString &message,
-                                  const QString &targetHost,
-                                  quint16 targetPort) {
-  QByteArray data = message.toUtf8();
-
+void UDPClientServer::sendData(const QByteArray &data,
+                               const QString &targetHost, quint16 targetPort) {
   // 检查消息大小
   if (data.size() > MAX_UDP_DATAGRAM_SIZE) {
     emit errorOccurred(QString("消息过大 (%1字节)，建议不超过%2字节")
@@ -69,15 +67,14 @@ void UDPClientServer::sendMessage(const QString &message,
                            .arg(data.size())
                            .arg(sent));
   } else {
-    qDebug() << "UDP发送成功 ->" << targetHost << ":" << targetPort
-             << "内容:" << message << "(字节数:" << data.size() << ")";
+    NET_DEBUG_LIMITED(lcNetUdp, m_logLimiter)
+        << "UDP发送成功 ->" << targetHost << ":" << targetPort
+        << "(字节数:" << data.size() << ")";
   }
 }
 
-void UDPClientServer::sendBroadcast(const QString &message,
-                                    quint16 targetPort) {
-  QByteArray data = message.toUtf8();
-
+void UDPClientServer::sendBroadcastData(const QByteArray &data,
+                                        quint16 targetPort) {
   // 检查消息大小
   if (data.size() > MAX_UDP_DATAGRAM_SIZE) {
     emit errorOccurred(QString("消息过大 (%1字节)，建议不超过%2字节")
@@ -94,11 +91,23 @@ void UDPClientServer::sendBroadcast(const QString &message,
                            .arg(data.size())
                            .arg(sent));
   } else {
-    qDebug() << "UDP广播成功 -> 端口:" << targetPort << "内容:" << message
-             << "(字节数:" << data.size() << ")";
+    NET_DEBUG_LIMITED(lcNetUdp, m_logLimiter)
+        << "UDP广播成功 -> 端口:" << targetPort
+        << "(字节数:" << data.size() << ")";
   }
 }
 
+void UDPClientServer::sendMessage(const QString &message,
+                                  const QString &targetHost,
+                                  quint16 targetPort) {
+  sendData(message.toUtf8(), targetHost, targetPort);
+}
+
+void UDPClientServer::sendBroadcast(const QString &message,
+                                    quint16 targetPort) {
+  sendBroadcastData(message.toUtf8(), targetPort);
+}
+
 bool UDPClientServer::isBound() const {
   return m_socket->state() == QAbstractSocket::BoundState;
 }
@@ -106,13 +115,19 @@ bool UDPClientServer::isBound() const {
 quint16 UDPClientServer::localPort() const { return m_socket->localPort(); }
 
 void UDPClientServer::onReadyRead() {
-  QByteArray datagram;
   QHostAddress senderAddress;
   quint16 senderPort;
 
+  // 只有在有字符串接收者时才做 UTF-8 解码
+  static const QMetaMethod messageReceivedSignal =
+      QMetaMethod::fromSignal(&UDPClientServer::messageReceived);
+  const bool decodeText = isSignalConnected(messageReceivedSignal);
+
   // 处理所有待接收的数据报
   while (m_socket->hasPendingDatagrams()) {
-    datagram.resize(static_cast<qsizetype>(m_socket->pendingDatagramSize()));
+    QByteArray datagram(
+        static_cast<qsizetype>(m_socket->pendingDatagramSize()),
+        Qt::Uninitialized);
 
     qint64 received = m_socket->readDatagram(datagram.data(), datagram.size(),
                                              &senderAddress, &senderPort);
@@ -121,9 +136,7 @@ void UDPClientServer::onReadyRead() {
       emit errorOccurred(QString("接收失败: %1").arg(m_socket->errorString()));
       continue;
     }
-
-    // 解码为UTF-8字符串
-    QString message = QString::fromUtf8(datagram.constData(), received);
+    datagram.resize(static_cast<qsizetype>(received));
 
     // 处理 IPv4/IPv6 地址显示
     QString senderAddressStr;
@@ -142,9 +155,15 @@ void UDPClientServer::onReadyRead() {
       senderAddressStr = senderAddress.toString();
     }
 
-    qDebug() << "UDP收到消息 <-" << senderAddressStr << ":" << senderPort
-             << "内容:" << message << "(字节数:" << received << ")";
+    NET_DEBUG_LIMITED(lcNetUdp, m_logLimiter)
+        << "UDP收到数据报 <-" << senderAddressStr << ":" << senderPort
+        << "(字节数:" << received << ")";
+    NET_DEBUG(lcNetPayload) << "UDP负载:" << NetLog::payloadPreview(datagram);
 
-    emit messageReceived(message, senderAddressStr, senderPort);
+    emit dataReceived(datagram, senderAddressStr, senderPort);
+    if (decodeText) {
+      emit messageReceived(QString::fromUtf8(datagram), senderAddressStr,
+                           senderPort);
+    }
   }
 }
@@ -1,6 +1,8 @@
 #ifndef UDPCLIENTSERVER_H
 #define UDPCLIENTSERVER_H
 
+#include "NetLog.h"
+#include <QByteArray>
 #include <QHostAddress>
 #include <QObject>
 #include <QString>
@@ -13,6 +15,7 @@
  * - 发送单播消息到指定地址
  * - 发送广播消息到局域网
  * - 自动处理 IPv4/IPv6 地址显示
+ * - 提供二进制接口（sendData/dataReceived），字符串接口只是其上的 UTF-8 封装
  *
  * 线程安全：
  * - 此类使用单线程事件驱动模型，不是线程安全的
@@ -34,11 +37,18 @@ public:
   // 解绑
   void unbind();
 
-  // 发送单播消息
+  // 发送单播二进制数据
+  void sendData(const QByteArray &data, const QString &targetHost,
+                quint16 targetPort);
+
+  // 发送广播二进制数据
+  void sendBroadcastData(const QByteArray &data, quint16 targetPort);
+
+  // 发送单播消息（UTF-8 编码后调用 sendData）
   void sendMessage(const QString &message, const QString &targetHost,
                    quint16 targetPort);
 
-  // 发送广播消息
+  // 发送广播消息（UTF-8 编码后调用 sendBroadcastData）
   void sendBroadcast(const QString &message, quint16 targetPort);
 
   // 获取绑定状态
@@ -54,7 +64,11 @@ signals:
   // 解绑
   void unbound();
 
-  // 接收到消息
+  // 接收到二进制数据报
+  void dataReceived(const QByteArray &data, const QString &senderAddress,
+                    quint16 senderPort);
+
+  // 接收到消息（UTF-8 解码，仅在有接收者连接时才解码）
   void messageReceived(const QString &message, const QString &senderAddress,
                        quint16 senderPort);
 
@@ -67,6 +81,7 @@ private slots:
 
 private:
   QUdpSocket *m_socket;
+  LogRateLimiter m_logLimiter; // 逐数据报日志限流
 };
 
 #endif // UDPCLIENTSERVER_H